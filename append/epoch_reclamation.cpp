@@ -0,0 +1,328 @@
+#include "epoch_reclamation.hpp"
+
+#include <algorithm>
+
+namespace tools {
+	namespace epoch_reclamation {
+		namespace {
+			// 存活回收域的注册表，线程退出时据此判断回收域是否仍然有效
+			std::mutex registry_mutex;
+			std::unordered_map<u64, domain*> registry;
+			std::atomic<u64> next_domain_id{ 1 };
+
+			thread_local local::thread_registrations registrations;
+		}
+
+		namespace local {
+			thread_registrations::~thread_registrations() {
+				std::lock_guard<std::mutex> registry_guard(registry_mutex);
+				for (auto& entry : entries) {
+					auto it = registry.find(entry.first);
+					if (it != registry.end()) {
+						it->second->release_record(entry.second);
+					}
+				}
+				entries.clear();
+			}
+		}
+
+		domain::domain(config config_)
+			: config_(config_), id_(next_domain_id.fetch_add(1, std::memory_order_relaxed))
+		{
+			if (this->config_.batch_size == 0) {
+				this->config_.batch_size = 1;
+			}
+			{
+				std::lock_guard<std::mutex> registry_guard(registry_mutex);
+				registry.insert({ id_, this });
+			}
+			if (this->config_.background) {
+				background_thread_ = std::thread(&domain::background_loop, this);
+			}
+		}
+
+		domain::~domain() {
+			{
+				std::lock_guard<std::mutex> registry_guard(registry_mutex);
+				registry.erase(id_);
+			}
+			if (background_thread_.joinable()) {
+				{
+					std::lock_guard<std::mutex> background_guard(background_mutex_);
+					background_stop_ = true;
+				}
+				background_cv_.notify_all();
+				background_thread_.join();
+			}
+
+			// 此时不应再有线程处于临界区，释放所有剩余对象
+			for (auto& batch : pending_) {
+				for (auto& node : batch.nodes) {
+					node.deleter_(node.ptr);
+				}
+			}
+			pending_.clear();
+
+			auto record = records_.load(std::memory_order_acquire);
+			while (record) {
+				for (auto& node : record->limbo) {
+					node.deleter_(node.ptr);
+				}
+				auto next = record->next;
+				delete record;
+				record = next;
+			}
+
+			// 清理当前线程对本域的登记
+			auto& entries = registrations.entries;
+			for (auto it = entries.begin(); it != entries.end(); ++it) {
+				if (it->first == id_) {
+					entries.erase(it);
+					break;
+				}
+			}
+		}
+
+		void domain::register_thread() {
+			acquire_record();
+		}
+
+		void domain::unregister_thread() {
+			auto& entries = registrations.entries;
+			for (auto it = entries.begin(); it != entries.end(); ++it) {
+				if (it->first == id_) {
+					auto record = it->second;
+					entries.erase(it);
+					release_record(record);
+					return;
+				}
+			}
+		}
+
+		local::thread_record* domain::acquire_record() {
+			for (auto& entry : registrations.entries) {
+				if (entry.first == id_) {
+					return entry.second;
+				}
+			}
+
+			// 优先复用已注销线程留下的记录
+			local::thread_record* record = records_.load(std::memory_order_acquire);
+			for (; record; record = record->next) {
+				bool expected = false;
+				if (!record->in_use.load(std::memory_order_relaxed) &&
+					record->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+					break;
+				}
+			}
+
+			if (!record) {
+				record = new local::thread_record();
+				record->in_use.store(true, std::memory_order_relaxed);
+				record->limbo.reserve(config_.batch_size);
+				auto head = records_.load(std::memory_order_relaxed);
+				do {
+					record->next = head;
+				} while (!records_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+			}
+
+			registrations.entries.push_back({ id_, record });
+			return record;
+		}
+
+		void domain::release_record(local::thread_record* record) {
+			if (!record->limbo.empty()) {
+				submit(record);
+			}
+			record->depth = 0;
+			record->state.store(0, std::memory_order_release);
+			record->in_use.store(false, std::memory_order_release);
+		}
+
+		domain::guard::guard(domain& domain_)
+			: domain_(domain_), record_(domain_.acquire_record())
+		{
+			if (record_->depth++ == 0) {
+				u64 epoch = domain_.global_epoch_.load(std::memory_order_relaxed);
+				record_->state.store((epoch << 1) | 1, std::memory_order_relaxed);
+				// 保证纪元的发布先于临界区内对共享指针的读取
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+			}
+		}
+
+		domain::guard::~guard() {
+			if (--record_->depth == 0) {
+				record_->state.store(0, std::memory_order_release);
+			}
+		}
+
+		void domain::retire(void* ptr, deleter deleter_, u64 bytes) {
+			if (!ptr) {
+				return;
+			}
+			auto record = acquire_record();
+			record->limbo.push_back({ ptr, deleter_, bytes });
+			record->limbo_bytes += bytes;
+			record->limbo_epoch = global_epoch_.load(std::memory_order_acquire);
+
+			if (record->limbo.size() >= config_.batch_size || record->limbo_bytes >= config_.thread_bytes_limit) {
+				submit(record);
+			}
+		}
+
+		void domain::flush() {
+			auto record = acquire_record();
+			if (!record->limbo.empty()) {
+				submit(record);
+			}
+		}
+
+		void domain::submit(local::thread_record* record) {
+			local::retired_batch batch{ std::move(record->limbo), record->limbo_epoch, record->limbo_bytes, record };
+			record->limbo.clear();
+			record->limbo.reserve(config_.batch_size);
+			record->limbo_bytes = 0;
+
+			u64 outstanding = record->outstanding_bytes.fetch_add(batch.bytes, std::memory_order_relaxed) + batch.bytes;
+			pending_count_.fetch_add(batch.nodes.size(), std::memory_order_relaxed);
+			pending_bytes_.fetch_add(batch.bytes, std::memory_order_relaxed);
+			{
+				std::lock_guard<threaded_data_container::spin_lock> pending_guard(pending_lock_);
+				pending_.push_back(std::move(batch));
+			}
+
+			// 没有后台线程，或本线程占用超过上限时，同步回收
+			if (!config_.background || outstanding > config_.thread_bytes_limit) {
+				collect();
+			}
+		}
+
+		bool domain::try_advance() {
+			u64 epoch = global_epoch_.load(std::memory_order_seq_cst);
+			for (auto record = records_.load(std::memory_order_acquire); record; record = record->next) {
+				u64 state = record->state.load(std::memory_order_seq_cst);
+				if ((state & 1) && (state >> 1) != epoch) {
+					return false;
+				}
+			}
+			return global_epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+		}
+
+		u64 domain::collect() {
+			try_advance();
+			u64 epoch = global_epoch_.load(std::memory_order_acquire);
+
+			// 在锁内挑出已安全的批次，在锁外执行释放
+			std::vector<local::retired_batch> ready;
+			{
+				std::lock_guard<threaded_data_container::spin_lock> pending_guard(pending_lock_);
+				auto it = std::partition(pending_.begin(), pending_.end(), [epoch](const local::retired_batch& batch) {
+					return batch.epoch + 2 > epoch;
+					});
+				ready.assign(std::make_move_iterator(it), std::make_move_iterator(pending_.end()));
+				pending_.erase(it, pending_.end());
+			}
+
+			u64 count = 0;
+			for (auto& batch : ready) {
+				for (auto& node : batch.nodes) {
+					node.deleter_(node.ptr);
+				}
+				count += batch.nodes.size();
+				batch.owner->outstanding_bytes.fetch_sub(batch.bytes, std::memory_order_relaxed);
+				pending_count_.fetch_sub(batch.nodes.size(), std::memory_order_relaxed);
+				pending_bytes_.fetch_sub(batch.bytes, std::memory_order_relaxed);
+			}
+			return count;
+		}
+
+		u64 domain::get_epoch() const {
+			return global_epoch_.load(std::memory_order_acquire);
+		}
+
+		u64 domain::get_pending_count() const {
+			return pending_count_.load(std::memory_order_relaxed);
+		}
+
+		u64 domain::get_pending_bytes() const {
+			return pending_bytes_.load(std::memory_order_relaxed);
+		}
+
+		void domain::background_loop() {
+			std::unique_lock<std::mutex> background_guard(background_mutex_);
+			while (!background_stop_) {
+				background_cv_.wait_for(background_guard, config_.background_interval, [this]() { return background_stop_; });
+				if (background_stop_) {
+					break;
+				}
+				background_guard.unlock();
+				collect();
+				background_guard.lock();
+			}
+		}
+	}
+
+	namespace test {
+#ifdef tools_debug
+		u64 epoch_reclamation_test() {
+			using namespace tools::epoch_reclamation;
+
+			struct node {
+				u64 value;
+			};
+			static std::atomic<u64> deleted{ 0 };
+			deleted.store(0);
+
+			u64 error = 0;
+			u64 retired = 0;
+			{
+				config config_;
+				config_.batch_size = 16;
+				domain domain_(config_);
+				std::atomic<node*> shared{ new node{ 0 } };
+				std::atomic<bool> stop{ false };
+
+				// 读者在临界区内反复读取共享指针
+				std::vector<std::thread> readers;
+				std::atomic<u64> bad_reads{ 0 };
+				for (i32 i = 0; i < 2; ++i) {
+					readers.emplace_back([&]() {
+						while (!stop.load(std::memory_order_relaxed)) {
+							domain::guard guard(domain_);
+							node* current = shared.load(std::memory_order_acquire);
+							if (current->value == ~0ull) {
+								bad_reads.fetch_add(1);
+							}
+						}
+						domain_.unregister_thread();
+						});
+				}
+
+				// 写者替换并退休旧节点
+				for (u64 i = 1; i <= 10000; ++i) {
+					node* old = shared.exchange(new node{ i }, std::memory_order_acq_rel);
+					domain_.retire(old, [](void* p) {
+						static_cast<node*>(p)->value = ~0ull;
+						delete static_cast<node*>(p);
+						deleted.fetch_add(1);
+						}, sizeof(node));
+					++retired;
+				}
+				stop.store(true);
+				for (auto& reader : readers) {
+					reader.join();
+				}
+				domain_.flush();
+				for (i32 i = 0; i < 3; ++i) {
+					domain_.collect();
+				}
+				if (bad_reads.load() != 0 || domain_.get_pending_count() != 0 || deleted.load() != retired) {
+					error |= 结果错误;
+				}
+				delete shared.load();
+			}
+			return error;
+		}
+#endif
+	}
+}
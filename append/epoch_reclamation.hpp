@@ -0,0 +1,151 @@
+#pragma once
+#include "../tools.hpp"
+#include "./threaded_data_container.hpp"
+#include "./time.hpp"
+
+#include <mutex>
+#include <condition_variable>
+
+
+namespace tools {
+	namespace epoch_reclamation {
+		// 回收函数类型，用于释放被退休的对象
+		using deleter = void(*)(void*);
+
+		// 回收域配置
+		struct config {
+			u64 batch_size = 64;				// 线程本地攒够多少个退休对象后提交为一个批次
+			u64 thread_bytes_limit = 1 << 20;	// 单个线程已退休但未释放的字节上限，超过后由该线程同步回收
+			bool background = true;				// 是否启动后台回收线程
+			time::seconds_nano background_interval = time::seconds_nano(10'000'000); // 后台回收间隔
+		};
+
+		class domain;
+
+		namespace local {
+			struct thread_record;
+
+			// 一个退休对象
+			struct retired_node {
+				void* ptr;
+				deleter deleter_;
+				u64 bytes;
+			};
+
+			// 一批退休对象，epoch 为批次内最晚的退休纪元
+			struct retired_batch {
+				std::vector<retired_node> nodes;
+				u64 epoch;
+				u64 bytes;
+				thread_record* owner;
+			};
+
+			// 每个注册线程的记录，只在回收域析构时释放
+			struct alignas(64) thread_record {
+				std::atomic<u64> state{ 0 };				// (epoch << 1) | 是否处于临界区
+				std::atomic<bool> in_use{ false };			// 是否被某个线程占用
+				std::atomic<u64> outstanding_bytes{ 0 };	// 已提交但尚未释放的字节数
+				u32 depth = 0;								// 临界区嵌套深度（仅所属线程访问）
+				std::vector<retired_node> limbo;			// 尚未提交的退休对象（仅所属线程访问）
+				u64 limbo_bytes = 0;
+				u64 limbo_epoch = 0;
+				thread_record* next = nullptr;
+			};
+
+			// 线程退出时自动注销仍存活的回收域
+			struct thread_registrations {
+				std::vector<std::pair<u64, thread_record*>> entries;
+				~thread_registrations();
+			};
+		}
+
+		// 基于纪元的内存回收域（EBR）
+		// 读者在 guard 保护的临界区内访问共享指针；写者摘除对象后调用 retire，
+		// 当全局纪元前进两次后，所有可能持有该对象的临界区都已退出，对象才会被释放。
+		// 析构时不允许有线程处于临界区内，所有未释放的对象都会被立即释放。
+		class domain {
+		public:
+			domain(config config_ = config());
+			~domain();
+
+			domain(const domain&) = delete;
+			domain& operator=(const domain&) = delete;
+
+			// 注册当前线程（guard / retire 会自动注册）
+			void register_thread();
+
+			// 注销当前线程，未提交的退休对象会被提交
+			void unregister_thread();
+
+			// RAII 风格的临界区守卫，可嵌套
+			class guard {
+			public:
+				guard(domain& domain_);
+				~guard();
+
+				guard(const guard&) = delete;
+				guard& operator=(const guard&) = delete;
+
+			private:
+				domain& domain_;
+				local::thread_record* record_;
+			};
+
+			// 退休一个对象  ptr:对象指针 deleter_:释放函数 bytes:对象大小（用于限额统计）
+			void retire(void* ptr, deleter deleter_, u64 bytes = 0);
+
+			// 退休一个通过 new 分配的对象
+			template <typename T>
+			void retire(T* ptr) {
+				retire(ptr, [](void* p) { delete static_cast<T*>(p); }, sizeof(T));
+			}
+
+			// 将当前线程未提交的退休对象提交为一个批次
+			void flush();
+
+			// 尝试推进全局纪元，所有活跃线程都已观察到当前纪元时成功
+			bool try_advance();
+
+			// 释放所有已安全的批次，返回释放的对象数量
+			u64 collect();
+
+			// 获取当前全局纪元
+			u64 get_epoch() const;
+
+			// 获取已提交但尚未释放的对象数量
+			u64 get_pending_count() const;
+
+			// 获取已提交但尚未释放的字节数
+			u64 get_pending_bytes() const;
+
+		private:
+			friend struct local::thread_registrations;
+
+			local::thread_record* acquire_record();
+			void release_record(local::thread_record* record);
+			void submit(local::thread_record* record);
+			void background_loop();
+
+			config config_;
+			u64 id_;
+			std::atomic<u64> global_epoch_{ 0 };
+			std::atomic<local::thread_record*> records_{ nullptr };
+
+			threaded_data_container::spin_lock pending_lock_;
+			std::vector<local::retired_batch> pending_;
+			std::atomic<u64> pending_count_{ 0 };
+			std::atomic<u64> pending_bytes_{ 0 };
+
+			std::mutex background_mutex_;
+			std::condition_variable background_cv_;
+			bool background_stop_ = false;
+			std::thread background_thread_;
+		};
+	}
+
+	namespace test {
+#ifdef tools_debug
+		u64 epoch_reclamation_test();
+#endif
+	}
+}
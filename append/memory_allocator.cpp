@@ -1,14 +1,1543 @@
 #include "memory_allocator.hpp"
+
+#include <bit>
+#include <list>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
 namespace tools {
 	namespace memory_allocator {
+		namespace local {
+			u64 page_size() {
+				static const u64 size = []() -> u64 {
+#if defined(_WIN32)
+					SYSTEM_INFO info;
+					GetSystemInfo(&info);
+					return info.dwPageSize;
+#else
+					long size = sysconf(_SC_PAGESIZE);
+					return size > 0 ? static_cast<u64>(size) : 4096;
+#endif
+				}();
+				return size;
+			}
+
+			byte* map_pages(u64 bytes, bool huge_pages) {
+#if defined(_WIN32)
+				// 大页需要 SeLockMemoryPrivilege 且不可换出，这里不使用
+				(void)huge_pages;
+				return static_cast<byte*>(VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+				void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (base == MAP_FAILED) {
+					return nullptr;
+				}
+#if defined(MADV_HUGEPAGE)
+				if (huge_pages) {
+					madvise(base, bytes, MADV_HUGEPAGE);	// 仅为建议，失败时退回普通页
+				}
+#else
+				(void)huge_pages;
+#endif
+				return static_cast<byte*>(base);
+#endif
+			}
+
+			void unmap_pages(byte* base, u64 bytes) {
+#if defined(_WIN32)
+				(void)bytes;
+				VirtualFree(base, 0, MEM_RELEASE);
+#else
+				munmap(base, bytes);
+#endif
+			}
+		}
+
+		namespace local {
+			struct alignas(64) stats_record {
+				static constexpr u32 fields = 4 + allocation_counters::histogram_buckets;
+				enum field : u32 { allocations, frees, allocated_bytes, freed_bytes, histogram };
+
+				std::atomic<u64> values[allocation_stats::max_tags][fields];	// 只由所属线程写入
+				i64 pending = 0;						// 尚未合并到峰值统计的存活字节变化
+				std::atomic<bool> in_use{ false };
+				stats_record* next = nullptr;
+			};
+		}
+
+		namespace {
+			// 存活统计对象的注册表，线程退出时据此判断统计对象是否仍然有效
+			std::mutex stats_registry_mutex;
+			std::unordered_map<u64, allocation_stats*> stats_registry;
+			std::atomic<u64> next_stats_id{ 1 };
+
+			thread_local local::stats_registrations thread_stats_registrations;
+			thread_local u64 last_stats_id = 0;
+			thread_local local::stats_record* last_stats_record = nullptr;
+			thread_local u32 thread_tag = 0;
+
+			struct tag_table {
+				std::mutex mutex;
+				std::vector<std::string> names{ "untagged" };
+			};
+
+			tag_table& tags() {
+				static tag_table table;
+				return table;
+			}
+
+			inline u32 histogram_bucket(u64 bytes) {
+				return std::min<u32>(static_cast<u32>(std::bit_width(bytes)), allocation_counters::histogram_buckets - 1);
+			}
+
+			// 单写者计数，不需要原子读改写
+			inline void bump(std::atomic<u64>& value, u64 delta) {
+				value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+			}
+
+			std::string json_escape(const std::string& text) {
+				std::string out;
+				for (char c : text) {
+					if (c == '"' || c == '\\') {
+						out += '\\';
+						out += c;
+					}
+					else if (static_cast<unsigned char>(c) < 0x20) {
+						char buffer[8];
+						std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+						out += buffer;
+					}
+					else {
+						out += c;
+					}
+				}
+				return out;
+			}
+
+			void counters_to_json(std::ostringstream& out, const allocation_counters& counters) {
+				out << "\"live_bytes\": " << counters.live_bytes()
+					<< ", \"allocations\": " << counters.allocations
+					<< ", \"frees\": " << counters.frees
+					<< ", \"allocated_bytes\": " << counters.allocated_bytes
+					<< ", \"freed_bytes\": " << counters.freed_bytes
+					<< ", \"histogram\": [";
+				for (u32 i = 0; i < allocation_counters::histogram_buckets; ++i) {
+					out << (i ? ", " : "") << counters.histogram[i];
+				}
+				out << "]";
+			}
+
+			void counters_to_text(std::ostringstream& out, const allocation_counters& counters) {
+				out << "live " << counters.live_bytes() << " B, allocations " << counters.allocations
+					<< ", frees " << counters.frees << ", allocated " << counters.allocated_bytes << " B\n";
+				for (u32 i = 0; i < allocation_counters::histogram_buckets; ++i) {
+					if (counters.histogram[i]) {
+						out << "    < " << (u64(1) << i) << " B: " << counters.histogram[i] << "\n";
+					}
+				}
+			}
+		}
+
+		namespace local {
+			stats_registrations::~stats_registrations() {
+				std::lock_guard<std::mutex> registry_guard(stats_registry_mutex);
+				for (auto& entry : entries) {
+					auto it = stats_registry.find(entry.first);
+					if (it != stats_registry.end()) {
+						it->second->release_record(entry.second);
+					}
+				}
+				entries.clear();
+				last_stats_id = 0;
+				last_stats_record = nullptr;
+			}
+		}
+
+		allocation_counters& allocation_counters::operator+=(const allocation_counters& other) {
+			allocations += other.allocations;
+			frees += other.frees;
+			allocated_bytes += other.allocated_bytes;
+			freed_bytes += other.freed_bytes;
+			for (u32 i = 0; i < histogram_buckets; ++i) {
+				histogram[i] += other.histogram[i];
+			}
+			return *this;
+		}
+
+		std::string allocation_snapshot::to_text() const {
+			std::ostringstream out;
+			out << "allocation stats" << (name.empty() ? "" : " [" + name + "]") << ": peak " << peak_bytes << " B\n  total: ";
+			counters_to_text(out, total);
+			for (auto& tag : tags) {
+				out << "  " << tag.first << ": ";
+				counters_to_text(out, tag.second);
+			}
+			return out.str();
+		}
+
+		std::string allocation_snapshot::to_json() const {
+			std::ostringstream out;
+			out << "{\"name\": \"" << json_escape(name) << "\", \"peak_bytes\": " << peak_bytes << ", ";
+			counters_to_json(out, total);
+			out << ", \"tags\": [";
+			for (size_t i = 0; i < tags.size(); ++i) {
+				out << (i ? ", " : "") << "{\"tag\": \"" << json_escape(tags[i].first) << "\", ";
+				counters_to_json(out, tags[i].second);
+				out << "}";
+			}
+			out << "]}";
+			return out.str();
+		}
+
+		u32 allocation_stats::register_tag(std::string_view name) {
+			auto& table = tags();
+			std::lock_guard<std::mutex> guard(table.mutex);
+			for (u32 i = 0; i < table.names.size(); ++i) {
+				if (table.names[i] == name) {
+					return i;
+				}
+			}
+			if (table.names.size() >= max_tags) {
+				return 0;
+			}
+			table.names.emplace_back(name);
+			return static_cast<u32>(table.names.size() - 1);
+		}
+
+		u32 allocation_stats::current_tag() {
+			return thread_tag;
+		}
+
+		std::string allocation_stats::tag_name(u32 tag) {
+			auto& table = tags();
+			std::lock_guard<std::mutex> guard(table.mutex);
+			return tag < table.names.size() ? table.names[tag] : table.names[0];
+		}
+
+		allocation_stats::tag_scope::tag_scope(u32 tag) : previous_(thread_tag) {
+			thread_tag = tag < max_tags ? tag : 0;
+		}
+
+		allocation_stats::tag_scope::~tag_scope() {
+			thread_tag = previous_;
+		}
+
+		allocation_stats::allocation_stats(std::string name)
+			: name_(std::move(name)), id_(next_stats_id.fetch_add(1, std::memory_order_relaxed))
+		{
+			std::lock_guard<std::mutex> registry_guard(stats_registry_mutex);
+			stats_registry.insert({ id_, this });
+		}
+
+		allocation_stats::~allocation_stats() {
+			{
+				std::lock_guard<std::mutex> registry_guard(stats_registry_mutex);
+				stats_registry.erase(id_);
+			}
+
+			auto& entries = thread_stats_registrations.entries;
+			for (auto it = entries.begin(); it != entries.end(); ++it) {
+				if (it->first == id_) {
+					entries.erase(it);
+					break;
+				}
+			}
+			if (last_stats_id == id_) {
+				last_stats_id = 0;
+				last_stats_record = nullptr;
+			}
+
+			auto record = records_.load(std::memory_order_acquire);
+			while (record) {
+				auto next = record->next;
+				delete record;
+				record = next;
+			}
+		}
+
+		local::stats_record* allocation_stats::get_record() {
+			if (last_stats_id == id_) {
+				return last_stats_record;
+			}
+
+			local::stats_record* record = nullptr;
+			for (auto& entry : thread_stats_registrations.entries) {
+				if (entry.first == id_) {
+					record = entry.second;
+					break;
+				}
+			}
+
+			if (!record) {
+				// 优先复用已退出线程留下的记录，计数继续累加
+				for (record = records_.load(std::memory_order_acquire); record; record = record->next) {
+					bool expected = false;
+					if (!record->in_use.load(std::memory_order_relaxed) &&
+						record->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+						break;
+					}
+				}
+				if (!record) {
+					record = new local::stats_record();
+					record->in_use.store(true, std::memory_order_relaxed);
+					auto head = records_.load(std::memory_order_relaxed);
+					do {
+						record->next = head;
+					} while (!records_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+				}
+				thread_stats_registrations.entries.push_back({ id_, record });
+			}
+
+			last_stats_id = id_;
+			last_stats_record = record;
+			return record;
+		}
+
+		void allocation_stats::release_record(local::stats_record* record) {
+			add_live(record->pending);
+			record->pending = 0;
+			record->in_use.store(false, std::memory_order_release);
+		}
+
+		void allocation_stats::add_live(i64 delta) {
+			i64 live = live_.fetch_add(delta, std::memory_order_relaxed) + delta;
+			i64 peak = peak_.load(std::memory_order_relaxed);
+			while (live > peak && !peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+			}
+		}
+
+		void allocation_stats::record_allocate(u64 bytes, u64 count, u32 tag) {
+			auto record = get_record();
+			auto& values = record->values[tag < max_tags ? tag : 0];
+			bump(values[local::stats_record::allocations], count);
+			bump(values[local::stats_record::allocated_bytes], bytes * count);
+			bump(values[local::stats_record::histogram + histogram_bucket(bytes)], count);
+
+			record->pending += static_cast<i64>(bytes * count);
+			if (record->pending >= static_cast<i64>(peak_flush_bytes)) {
+				add_live(record->pending);
+				record->pending = 0;
+			}
+		}
+
+		void allocation_stats::record_free(u64 bytes, u64 count, u32 tag) {
+			auto record = get_record();
+			auto& values = record->values[tag < max_tags ? tag : 0];
+			bump(values[local::stats_record::frees], count);
+			bump(values[local::stats_record::freed_bytes], bytes * count);
+
+			record->pending -= static_cast<i64>(bytes * count);
+			if (record->pending <= -static_cast<i64>(peak_flush_bytes)) {
+				add_live(record->pending);
+				record->pending = 0;
+			}
+		}
+
+		allocation_snapshot allocation_stats::snapshot() const {
+			allocation_snapshot snapshot;
+			snapshot.name = name_;
+			allocation_counters per_tag[max_tags];
+			for (auto record = records_.load(std::memory_order_acquire); record; record = record->next) {
+				for (u32 tag = 0; tag < max_tags; ++tag) {
+					auto& values = record->values[tag];
+					auto& counters = per_tag[tag];
+					counters.allocations += values[local::stats_record::allocations].load(std::memory_order_relaxed);
+					counters.frees += values[local::stats_record::frees].load(std::memory_order_relaxed);
+					counters.allocated_bytes += values[local::stats_record::allocated_bytes].load(std::memory_order_relaxed);
+					counters.freed_bytes += values[local::stats_record::freed_bytes].load(std::memory_order_relaxed);
+					for (u32 i = 0; i < allocation_counters::histogram_buckets; ++i) {
+						counters.histogram[i] += values[local::stats_record::histogram + i].load(std::memory_order_relaxed);
+					}
+				}
+			}
+			for (u32 tag = 0; tag < max_tags; ++tag) {
+				snapshot.total += per_tag[tag];
+				if (per_tag[tag].allocations || per_tag[tag].frees) {
+					snapshot.tags.push_back({ tag_name(tag), per_tag[tag] });
+				}
+			}
+			snapshot.peak_bytes = static_cast<u64>(std::max<i64>({ peak_.load(std::memory_order_relaxed), snapshot.total.live_bytes(), 0 }));
+			return snapshot;
+		}
+
+		std::string system_allocator::leak_report(u64 max_blocks) const {
+			u64 count = 0;
+			u64 bytes = 0;
+			std::ostringstream lines;
+			for (auto header = head_; header; header = header->next) {
+				if (count < max_blocks) {
+					lines << "  " << static_cast<const void*>(header + 1) << " " << header->size << " B "
+						<< (header->magic == new_magic ? "new_" : header->magic == raw_magic ? "allocate_" : "malloc_")
+						<< (header->mapped ? " mapped" : "") << " [" << allocation_stats::tag_name(header->tag) << "]\n";
+				}
+				++count;
+				bytes += header->size;
+			}
+			if (count == 0) {
+				return {};
+			}
+			std::ostringstream out;
+			out << "system_allocator";
+			if (stats_ && !stats_->get_name().empty()) {
+				out << " [" << stats_->get_name() << "]";
+			}
+			out << ": " << count << " live blocks, " << bytes << " B\n" << lines.str();
+			if (count > max_blocks) {
+				out << "  ... " << (count - max_blocks) << " more\n";
+			}
+			return out.str();
+		}
+
+		block<byte> system_allocator::malloc_(u64 size, u64 alignment, page_options options) {
+			if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > (u64(1) << 30)) {
+				return block<byte>(nullptr, size);
+			}
+
+			local::system_header* header = nullptr;
+			if (size >= options.map_threshold || options.huge_pages) {
+				if (options.huge_pages) {
+					alignment = std::max(alignment, huge_page_size);
+				}
+				header = map_header(size, alignment, options.huge_pages);
+			}
+			else {
+				header = allocate_header(size, alignment, std::nothrow);
+			}
+			if (!header) {
+				return block<byte>(nullptr, size);
+			}
+			header->magic = malloc_magic;
+
+			byte* data = data_of<byte>(header);
+			if (options.prefault) {
+				// 每页写入一次以触发缺页（malloc_ 返回的内容本就未定义）
+				u64 page = local::page_size();
+				for (u64 i = 0; i < size; i += page) {
+					reinterpret_cast<volatile byte*>(data)[i] = 0;
+				}
+			}
+			return block<byte>(data, size);
+		}
+
+		local::system_header* system_allocator::map_header(u64 bytes, u64 alignment, bool huge_pages) {
+			alignment = std::max<u64>(alignment, alignof(local::system_header));
+			// 加上块头空间并按页向上取整后不能回绕
+			if (bytes > std::numeric_limits<u64>::max() - std::max<u64>(alignment, local::page_size()) - (local::page_size() - 1)) {
+				return nullptr;
+			}
+			u64 length = mapped_bytes(bytes, alignment);
+			byte* base = local::map_pages(length, huge_pages);
+			if (!base) {
+				return nullptr;
+			}
+			byte* data = local::align_up(base + sizeof(local::system_header), std::max<u64>(alignment, local::page_size()));
+			if (!track(data, bytes)) {
+				local::unmap_pages(base, length);
+				return nullptr;
+			}
+			auto header = reinterpret_cast<local::system_header*>(data) - 1;
+			header->owner = this;
+			header->type = nullptr;
+			header->destroy = nullptr;
+			header->offset = static_cast<u32>(data - base);
+			header->alignment = static_cast<u32>(alignment);
+			header->mapped = 1;
+			link(header, bytes);
+			return header;
+		}
+
+		arena_allocator::arena_allocator(u64 chunk_size)
+			: chunk_size_(chunk_size ? chunk_size : 64 * 1024)
+		{
+		}
+
+		arena_allocator::~arena_allocator() {
+			release();
+		}
+
+		void arena_allocator::enter_chunk(local::arena_chunk* chunk) {
+			current_ = chunk;
+			top_ = chunk ? chunk->data() : nullptr;
+			end_ = chunk ? chunk->end : nullptr;
+		}
+
+		byte* arena_allocator::allocate_slow(u64 size, u64 alignment) {
+			// 优先复用 reset / rewind 后留下的后续大块
+			while (current_ && current_->next) {
+				enter_chunk(current_->next);
+				byte* aligned = local::align_up(top_, alignment);
+				if (aligned <= end_ && size <= static_cast<u64>(end_ - aligned)) {
+					top_ = aligned + size;
+					return aligned;
+				}
+			}
+
+			// 申请新的大块，接在当前大块之后；容量加上对齐余量与块头后不能回绕
+			if (size > std::numeric_limits<u64>::max() - alignment - sizeof(local::arena_chunk)) {
+				throw std::bad_alloc();
+			}
+			u64 capacity = std::max(chunk_size_, size + alignment);
+			auto chunk = static_cast<local::arena_chunk*>(std::malloc(sizeof(local::arena_chunk) + capacity));
+			if (!chunk) {
+				throw std::bad_alloc();
+			}
+			chunk->end = chunk->data() + capacity;
+			if (current_) {
+				chunk->next = current_->next;
+				current_->next = chunk;
+			}
+			else {
+				chunk->next = nullptr;
+				head_ = chunk;
+			}
+			enter_chunk(chunk);
+
+			byte* aligned = local::align_up(top_, alignment);
+			top_ = aligned + size;
+			return aligned;
+		}
+
+		void arena_allocator::record_allocate(u64 size) {
+			stats_->record_allocate(size);
+			recorded_ += size;
+		}
+
+		void arena_allocator::record_rewind(u64 recorded) {
+			if (stats_ && recorded_ > recorded) {
+				stats_->record_free(recorded_ - recorded);
+			}
+			recorded_ = std::min(recorded_, recorded);
+		}
+
+		void arena_allocator::rewind(marker position) {
+			if (!position.chunk) {
+				reset();
+				return;
+			}
+			record_rewind(position.recorded);
+			current_ = position.chunk;
+			top_ = position.top;
+			end_ = position.chunk->end;
+		}
+
+		void arena_allocator::reset() {
+			record_rewind(0);
+			enter_chunk(head_);
+		}
+
+		void arena_allocator::release() {
+			auto chunk = head_;
+			while (chunk) {
+				auto next = chunk->next;
+				std::free(chunk);
+				chunk = next;
+			}
+			head_ = nullptr;
+			enter_chunk(nullptr);
+			record_rewind(0);
+		}
+
+		u64 arena_allocator::get_used() const {
+			u64 used = 0;
+			for (auto chunk = head_; chunk && chunk != current_; chunk = chunk->next) {
+				used += static_cast<u64>(chunk->end - chunk->data());
+			}
+			if (current_) {
+				used += static_cast<u64>(top_ - current_->data());
+			}
+			return used;
+		}
+
+		u64 arena_allocator::get_reserved() const {
+			u64 reserved = 0;
+			for (auto chunk = head_; chunk; chunk = chunk->next) {
+				reserved += static_cast<u64>(chunk->end - chunk->data());
+			}
+			return reserved;
+		}
+
+		namespace local {
+			// 攒批中的远程释放块，归属同一个线程缓存
+			struct remote_slot {
+				thread_cache* owner;
+				cached_free_block* head;
+				cached_free_block* tail;
+				u32 count;
+			};
+
+			struct alignas(64) thread_cache {
+				struct free_list {
+					cached_free_block* head = nullptr;
+					u32 count = 0;
+				};
+
+				free_list lists[caching_allocator::class_count];
+				remote_slot remote[8] = {};
+				std::atomic<cached_free_block*> remote_head{ nullptr };	// 其他线程归还的块
+				std::atomic<bool> in_use{ false };
+				thread_cache* next = nullptr;
+			};
+		}
+
+		namespace {
+			constexpr u32 cached_live_magic = 0x7A11C0DE;
+			constexpr u32 cached_free_magic = 0xF2EEB10C;
+			constexpr u32 remote_batch_size = 32;
+			constexpr u64 span_size = 64 * 1024;
+
+			// 存活分配器的注册表，线程退出时据此判断分配器是否仍然有效
+			std::mutex cache_registry_mutex;
+			std::unordered_map<u64, caching_allocator*> cache_registry;
+			std::atomic<u64> next_allocator_id{ 1 };
+
+			thread_local local::thread_cache_registrations cache_registrations;
+			thread_local u64 last_allocator_id = 0;
+			thread_local local::thread_cache* last_cache = nullptr;
+
+			inline local::cached_header* header_of(void* ptr) {
+				return static_cast<local::cached_header*>(ptr) - 1;
+			}
+		}
+
+		namespace local {
+			thread_cache_registrations::~thread_cache_registrations() {
+				std::lock_guard<std::mutex> registry_guard(cache_registry_mutex);
+				for (auto& entry : entries) {
+					auto it = cache_registry.find(entry.first);
+					if (it != cache_registry.end()) {
+						it->second->release_cache(entry.second);
+					}
+				}
+				entries.clear();
+				last_allocator_id = 0;
+				last_cache = nullptr;
+			}
+		}
+
+		caching_allocator::caching_allocator()
+			: id_(next_allocator_id.fetch_add(1, std::memory_order_relaxed))
+		{
+			std::lock_guard<std::mutex> registry_guard(cache_registry_mutex);
+			cache_registry.insert({ id_, this });
+		}
 
+		caching_allocator::~caching_allocator() {
+			{
+				std::lock_guard<std::mutex> registry_guard(cache_registry_mutex);
+				cache_registry.erase(id_);
+			}
+
+			auto& entries = cache_registrations.entries;
+			for (auto it = entries.begin(); it != entries.end(); ++it) {
+				if (it->first == id_) {
+					entries.erase(it);
+					break;
+				}
+			}
+			if (last_allocator_id == id_) {
+				last_allocator_id = 0;
+				last_cache = nullptr;
+			}
+
+			auto cache = caches_.load(std::memory_order_acquire);
+			while (cache) {
+				auto next = cache->next;
+				delete cache;
+				cache = next;
+			}
+			for (auto span : spans_) {
+				std::free(span);
+			}
+		}
+
+		u32 caching_allocator::size_to_class(u64 size) {
+			if (size <= 128) {
+				return static_cast<u32>((std::max<u64>(size, 1) + 15) / 16 - 1);
+			}
+			// 每个 2 的幂区间 (2^lg, 2^(lg+1)] 再均分为 4 级
+			u32 lg = static_cast<u32>(std::bit_width(size - 1) - 1);
+			u64 step = u64(1) << (lg - 2);
+			return 8 + (lg - 7) * 4 + static_cast<u32>((size - 1 - (u64(1) << lg)) / step);
+		}
+
+		u64 caching_allocator::class_to_size(u32 size_class) {
+			if (size_class < 8) {
+				return (size_class + 1) * 16;
+			}
+			u32 lg = 7 + (size_class - 8) / 4;
+			u32 sub = (size_class - 8) % 4;
+			return (u64(1) << lg) + (sub + 1) * (u64(1) << (lg - 2));
+		}
+
+		u32 caching_allocator::batch_size(u32 size_class) {
+			// 每级一批的块数，预先计算避免热路径上的除法
+			static const auto table = []() {
+				std::array<u32, class_count> sizes{};
+				for (u32 c = 0; c < class_count; ++c) {
+					sizes[c] = static_cast<u32>(std::clamp<u64>(span_size / class_to_size(c), 2, 64));
+				}
+				return sizes;
+				}();
+			return table[size_class];
+		}
+
+		local::thread_cache* caching_allocator::get_cache() {
+			if (last_allocator_id == id_) {
+				return last_cache;
+			}
+
+			local::thread_cache* cache = nullptr;
+			for (auto& entry : cache_registrations.entries) {
+				if (entry.first == id_) {
+					cache = entry.second;
+					break;
+				}
+			}
+
+			if (!cache) {
+				// 优先接管已退出线程留下的缓存
+				for (cache = caches_.load(std::memory_order_acquire); cache; cache = cache->next) {
+					bool expected = false;
+					if (!cache->in_use.load(std::memory_order_relaxed) &&
+						cache->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+						break;
+					}
+				}
+				if (!cache) {
+					cache = new local::thread_cache();
+					cache->in_use.store(true, std::memory_order_relaxed);
+					auto head = caches_.load(std::memory_order_relaxed);
+					do {
+						cache->next = head;
+					} while (!caches_.compare_exchange_weak(head, cache, std::memory_order_release, std::memory_order_relaxed));
+				}
+				cache_registrations.entries.push_back({ id_, cache });
+			}
+
+			last_allocator_id = id_;
+			last_cache = cache;
+			return cache;
+		}
+
+		void caching_allocator::release_cache(local::thread_cache* cache) {
+			for (u32 slot = 0; slot < 8; ++slot) {
+				flush_remote_slot(cache, slot);
+			}
+			drain_remote(cache);
+			for (u32 size_class = 0; size_class < class_count; ++size_class) {
+				if (cache->lists[size_class].count > 0) {
+					return_batch(cache, size_class, cache->lists[size_class].count);
+				}
+			}
+			cache->in_use.store(false, std::memory_order_release);
+		}
+
+		block<byte> caching_allocator::malloc_(u64 size) {
+			if (size > std::numeric_limits<u64>::max() - header_size) {
+				throw std::bad_alloc();
+			}
+			u64 total = std::max<u64>(size + header_size, header_size + sizeof(local::cached_free_block));
+			if (total > max_small_size) {
+				auto header = static_cast<local::cached_header*>(std::malloc(size + header_size));
+				if (!header) {
+					throw std::bad_alloc();
+				}
+				header->size_class = large_class;
+				header->magic = cached_live_magic;
+				header->large_size = size;
+				if (stats_) {
+					stats_->record_allocate(size);
+				}
+				return block<byte>(reinterpret_cast<byte*>(header + 1), size);
+			}
+
+			u32 size_class = size_to_class(total);
+			auto cache = get_cache();
+			auto& list = cache->lists[size_class];
+			if (!list.head) {
+				refill(cache, size_class);
+			}
+			auto free_block = list.head;
+			list.head = free_block->next;
+			--list.count;
+
+			auto header = header_of(free_block);
+			header->size_class = size_class;
+			header->magic = cached_live_magic;
+			header->owner = cache;
+			if (stats_) {
+				stats_->record_allocate(class_to_size(size_class) - header_size);
+			}
+			return block<byte>(reinterpret_cast<byte*>(free_block), size);
+		}
+
+		bool caching_allocator::owns(void* ptr) const {
+			return ptr && header_of(ptr)->magic == cached_live_magic;
+		}
+
+		bool caching_allocator::free_(block<byte>* block) {
+			if (!block || !free_(static_cast<void*>(block->start))) {
+				return false;
+			}
+			block->start = nullptr;
+			block->size = 0;
+			return true;
+		}
+
+		bool caching_allocator::free_(void* ptr) {
+			if (!owns(ptr)) {
+				return false;
+			}
+			auto header = header_of(ptr);
+			header->magic = cached_free_magic;
+			if (header->size_class == large_class) {
+				if (stats_) {
+					stats_->record_free(header->large_size);
+				}
+				std::free(header);
+				return true;
+			}
+			if (header->size_class >= class_count) {
+				return false;
+			}
+			if (stats_) {
+				stats_->record_free(class_to_size(header->size_class) - header_size);
+			}
+
+			auto cache = get_cache();
+			auto owner = static_cast<local::thread_cache*>(header->owner);
+			auto free_block = static_cast<local::cached_free_block*>(ptr);
+			if (owner != cache) {
+				push_remote(cache, owner, free_block);
+				return true;
+			}
+
+			u32 size_class = header->size_class;
+			auto& list = cache->lists[size_class];
+			free_block->next = list.head;
+			list.head = free_block;
+			++list.count;
+			if (list.count > 2 * batch_size(size_class)) {
+				return_batch(cache, size_class, batch_size(size_class));
+			}
+			return true;
+		}
+
+		void caching_allocator::flush_remote() {
+			auto cache = get_cache();
+			for (u32 slot = 0; slot < 8; ++slot) {
+				flush_remote_slot(cache, slot);
+			}
+		}
+
+		u64 caching_allocator::get_span_bytes() const {
+			return span_bytes_.load(std::memory_order_relaxed);
+		}
+
+		void caching_allocator::refill(local::thread_cache* cache, u32 size_class) {
+			auto& list = cache->lists[size_class];
+
+			// 先回收其他线程归还的块
+			drain_remote(cache);
+			if (list.head) {
+				return;
+			}
+
+			// 再从中心仓库取一批
+			{
+				auto& shard = depot_[size_class];
+				std::lock_guard<threaded_data_container::spin_lock> guard(shard.lock);
+				if (!shard.batches.empty()) {
+					list.head = shard.batches.back().first;
+					list.count = shard.batches.back().second;
+					shard.batches.pop_back();
+					return;
+				}
+			}
+
+			// 最后向系统申请新的 span 并切分
+			u64 slot_size = class_to_size(size_class);
+			u32 batch = batch_size(size_class);
+			u64 bytes = std::max<u64>(span_size, slot_size * batch * 2);
+			u64 slot_count = bytes / slot_size;
+			auto span = static_cast<byte*>(std::malloc(slot_count * slot_size));
+			if (!span) {
+				throw std::bad_alloc();
+			}
+			{
+				std::lock_guard<std::mutex> guard(span_mutex_);
+				spans_.push_back(span);
+			}
+			span_bytes_.fetch_add(slot_count * slot_size, std::memory_order_relaxed);
+
+			std::vector<std::pair<local::cached_free_block*, u32>> extra;
+			local::cached_free_block* head = nullptr;
+			u32 count = 0;
+			for (u64 i = slot_count; i-- > 0;) {
+				auto header = reinterpret_cast<local::cached_header*>(span + i * slot_size);
+				header->size_class = size_class;
+				header->magic = cached_free_magic;
+				header->owner = cache;
+				auto free_block = reinterpret_cast<local::cached_free_block*>(header + 1);
+				free_block->next = head;
+				head = free_block;
+				if (++count == batch && i > 0) {
+					extra.push_back({ head, count });
+					head = nullptr;
+					count = 0;
+				}
+			}
+			list.head = head;
+			list.count = count;
+			if (!extra.empty()) {
+				auto& shard = depot_[size_class];
+				std::lock_guard<threaded_data_container::spin_lock> guard(shard.lock);
+				shard.batches.insert(shard.batches.end(), extra.begin(), extra.end());
+			}
+		}
+
+		void caching_allocator::drain_remote(local::thread_cache* cache) {
+			auto free_block = cache->remote_head.exchange(nullptr, std::memory_order_acquire);
+			while (free_block) {
+				auto next = free_block->next;
+				auto& list = cache->lists[header_of(free_block)->size_class];
+				free_block->next = list.head;
+				list.head = free_block;
+				++list.count;
+				free_block = next;
+			}
+		}
+
+		void caching_allocator::push_remote(local::thread_cache* cache, local::thread_cache* owner, local::cached_free_block* block) {
+			u32 target = 8;
+			for (u32 slot = 0; slot < 8; ++slot) {
+				if (cache->remote[slot].owner == owner) {
+					target = slot;
+					break;
+				}
+				if (target == 8 && cache->remote[slot].count == 0) {
+					target = slot;
+				}
+			}
+			if (target == 8) {
+				// 没有空位时归还最满的一批
+				target = 0;
+				for (u32 slot = 1; slot < 8; ++slot) {
+					if (cache->remote[slot].count > cache->remote[target].count) {
+						target = slot;
+					}
+				}
+				flush_remote_slot(cache, target);
+			}
+
+			auto& remote = cache->remote[target];
+			remote.owner = owner;
+			block->next = remote.head;
+			remote.head = block;
+			if (!remote.tail) {
+				remote.tail = block;
+			}
+			if (++remote.count >= remote_batch_size) {
+				flush_remote_slot(cache, target);
+			}
+		}
+
+		void caching_allocator::flush_remote_slot(local::thread_cache* cache, u32 slot) {
+			auto& remote = cache->remote[slot];
+			if (remote.count == 0) {
+				return;
+			}
+			// 整批一次 CAS 挂到所属线程缓存的远程链表
+			auto head = remote.owner->remote_head.load(std::memory_order_relaxed);
+			do {
+				remote.tail->next = head;
+			} while (!remote.owner->remote_head.compare_exchange_weak(head, remote.head, std::memory_order_release, std::memory_order_relaxed));
+			remote = local::remote_slot{};
+		}
+
+		void caching_allocator::return_batch(local::thread_cache* cache, u32 size_class, u32 count) {
+			auto& list = cache->lists[size_class];
+			count = std::min(count, list.count);
+			if (count == 0) {
+				return;
+			}
+			auto head = list.head;
+			auto tail = head;
+			for (u32 i = 1; i < count; ++i) {
+				tail = tail->next;
+			}
+			list.head = tail->next;
+			list.count -= count;
+			tail->next = nullptr;
+
+			auto& shard = depot_[size_class];
+			std::lock_guard<threaded_data_container::spin_lock> guard(shard.lock);
+			shard.batches.push_back({ head, count });
+		}
+
+		buddy_allocator::buddy_allocator(u64 capacity, u64 min_block) {
+			min_block_ = std::bit_ceil(std::max<u64>(min_block, sizeof(local::buddy_node)));
+			min_shift_ = static_cast<u32>(std::countr_zero(min_block_));
+			u64 blocks = std::bit_ceil(std::max<u64>((capacity + min_block_ - 1) >> min_shift_, 1));
+			max_order_ = static_cast<u32>(std::countr_zero(blocks));
+			capacity_ = blocks << min_shift_;
+
+			base_ = local::map_pages(capacity_, false);
+			if (!base_) {
+				throw std::bad_alloc();
+			}
+			states_.assign(blocks, interior);
+			push_free(0, max_order_);
+			free_bytes_ = capacity_;
+		}
+
+		buddy_allocator::~buddy_allocator() {
+			local::unmap_pages(base_, capacity_);
+		}
+
+		u32 buddy_allocator::order_of(u64 size) const {
+			if (size <= min_block_) {
+				return 0;
+			}
+			return static_cast<u32>(std::bit_width((size - 1) >> min_shift_));
+		}
+
+		void buddy_allocator::push_free(u64 index, u32 order) {
+			auto node = node_at(index);
+			node->prev = nullptr;
+			node->next = free_lists_[order];
+			if (node->next) {
+				node->next->prev = node;
+			}
+			free_lists_[order] = node;
+			nonempty_ |= u64(1) << order;
+			states_[index] = static_cast<u8>(order);
+		}
+
+		void buddy_allocator::remove_free(u64 index, u32 order) {
+			auto node = node_at(index);
+			if (node->prev) {
+				node->prev->next = node->next;
+			}
+			else {
+				free_lists_[order] = node->next;
+				if (!node->next) {
+					nonempty_ &= ~(u64(1) << order);
+				}
+			}
+			if (node->next) {
+				node->next->prev = node->prev;
+			}
+			states_[index] = interior;
+		}
+
+		block<byte> buddy_allocator::malloc_(u64 size) {
+			if (size > capacity_) {
+				return block<byte>(nullptr, size);
+			}
+			u32 order = order_of(size);
+			u64 candidates = nonempty_ & (~u64(0) << order);
+			if (!candidates) {
+				return block<byte>(nullptr, size);
+			}
+
+			// 取能满足请求的最小空闲块，多余部分逐级拆成伙伴放回空闲链表
+			u32 current = static_cast<u32>(std::countr_zero(candidates));
+			u64 index = static_cast<u64>(reinterpret_cast<byte*>(free_lists_[current]) - base_) >> min_shift_;
+			remove_free(index, current);
+			while (current > order) {
+				--current;
+				push_free(index + (u64(1) << current), current);
+			}
+			states_[index] = static_cast<u8>(allocated | order);
+
+			u64 bytes = min_block_ << order;
+			free_bytes_ -= bytes;
+			if (stats_) {
+				stats_->record_allocate(bytes);
+			}
+			return block<byte>(base_ + (index << min_shift_), size);
+		}
+
+		bool buddy_allocator::free_(block<byte>* block) {
+			if (!block || !free_(static_cast<void*>(block->start))) {
+				return false;
+			}
+			block->start = nullptr;
+			block->size = 0;
+			return true;
+		}
+
+		bool buddy_allocator::free_(void* ptr) {
+			auto p = static_cast<byte*>(ptr);
+			if (!p || p < base_ || p >= base_ + capacity_ || (static_cast<u64>(p - base_) & (min_block_ - 1))) {
+				return false;
+			}
+			u64 index = static_cast<u64>(p - base_) >> min_shift_;
+			u8 state = states_[index];
+			if (state == interior || !(state & allocated)) {
+				return false;
+			}
+			u32 order = state & ~allocated;
+			u64 bytes = min_block_ << order;
+			free_bytes_ += bytes;
+			if (stats_) {
+				stats_->record_free(bytes);
+			}
+
+			// 伙伴同为该阶的空闲块时合并，直到伙伴被占用或拆分
+			states_[index] = interior;
+			while (order < max_order_) {
+				u64 buddy = index ^ (u64(1) << order);
+				if (states_[buddy] != order) {
+					break;
+				}
+				remove_free(buddy, order);
+				index = std::min(index, buddy);
+				++order;
+			}
+			push_free(index, order);
+			return true;
+		}
+
+		u64 buddy_allocator::get_largest_free_block() const {
+			if (!nonempty_) {
+				return 0;
+			}
+			return min_block_ << (63 - std::countl_zero(nonempty_));
+		}
+
+		f64 buddy_allocator::get_fragmentation() const {
+			if (free_bytes_ == 0) {
+				return 0;
+			}
+			return 1.0 - static_cast<f64>(get_largest_free_block()) / static_cast<f64>(free_bytes_);
+		}
+
+		void* caching_resource::do_allocate(size_t bytes, size_t alignment) {
+			if (alignment <= caching_allocator::header_size) {
+				return cache_.malloc_(bytes).start;
+			}
+			return upstream_->allocate(bytes, alignment);
+		}
+
+		void caching_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+			if (alignment <= caching_allocator::header_size) {
+				cache_.free_(ptr);
+			}
+			else {
+				upstream_->deallocate(ptr, bytes, alignment);
+			}
+		}
+
+		void* system_resource::do_allocate(size_t bytes, size_t alignment) {
+			if (upstream_ && alignment > alignof(std::max_align_t)) {
+				return upstream_->allocate(bytes, alignment);
+			}
+			auto raw = system_.malloc_(bytes, alignment, options_);
+			if (!raw.start) {
+				throw std::bad_alloc();
+			}
+			return raw.start;
+		}
+
+		void system_resource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+			if (upstream_ && alignment > alignof(std::max_align_t)) {
+				upstream_->deallocate(ptr, bytes, alignment);
+				return;
+			}
+			block<byte> raw(static_cast<byte*>(ptr), bytes);
+			system_.free_(&raw);
+		}
+
+		void* buddy_resource::do_allocate(size_t bytes, size_t alignment) {
+			if (alignment > local::page_size()) {
+				throw std::bad_alloc();
+			}
+			auto raw = buddy_.malloc_(std::max<u64>(bytes, alignment));
+			if (!raw.start) {
+				throw std::bad_alloc();
+			}
+			return raw.start;
+		}
+
+		void buddy_resource::do_deallocate(void* ptr, size_t, size_t) {
+			buddy_.free_(ptr);
+		}
 	}
 
 	namespace test {
 #ifdef tools_debug
 		u64 memory_allocator_test() {
-			return 0;
+			using namespace tools::memory_allocator;
+
+			u64 error = 0;
+
+			// 系统分配器：类型校验、归属校验与重复释放
+			{
+				static i32 alive = 0;
+				struct counted {
+					counted() { ++alive; }
+					~counted() { --alive; }
+				};
+				{
+					system_allocator allocator;
+					system_allocator other;
+					auto raw = allocator.malloc_(100);
+					auto copy = raw;
+					if (!raw.start || other.free_(&raw) || !allocator.free_(&raw) || allocator.free_(&raw)) {
+						error |= 结果错误;
+					}
+					(void)copy;
+
+					auto values = allocator.new_<u64>(16);
+					block<u32> wrong_type(reinterpret_cast<u32*>(values.start), 32);
+					if (allocator.delete_(wrong_type) || !allocator.delete_(values) || allocator.delete_(values)) {
+						error |= 结果错误;
+					}
+
+					auto objects = allocator.new_<counted>(10);
+					auto aligned = allocator.new_<std::max_align_t>(3);
+					if (alive != 10 || reinterpret_cast<uintptr_t>(aligned.start) % alignof(std::max_align_t) != 0) {
+						error |= 结果错误;
+					}
+					(void)objects;
+
+					// 指定对齐与页面映射：小块走堆，大块映射页面，析构时一并归还
+					auto page_aligned = allocator.malloc_(100, 4096);
+					page_options options;
+					options.huge_pages = true;
+					options.prefault = true;
+					auto mapped = allocator.malloc_(3 * 1024 * 1024, 64, options);
+					auto leaked = allocator.malloc_(2 * 1024 * 1024, 4096);
+					if (!page_aligned.start || reinterpret_cast<uintptr_t>(page_aligned.start) % 4096 != 0 ||
+						!mapped.start || reinterpret_cast<uintptr_t>(mapped.start) % huge_page_size != 0 ||
+						!leaked.start || reinterpret_cast<uintptr_t>(leaked.start) % 4096 != 0 ||
+						allocator.malloc_(100, 3).start || allocator.malloc_(~0ull - 8, 4096).start) {
+						error |= 结果错误;
+					}
+					std::memset(mapped.start, 0x5A, mapped.size);
+					if (!allocator.free_(&page_aligned) || !allocator.free_(&mapped) || allocator.free_(&mapped)) {
+						error |= 结果错误;
+					}
+					// 过期副本的重复释放：映射块与 C 运行库可能单独映射的大块在释放后块头已不可读，须返回 false 而不是访问它
+					auto mapped_block = allocator.malloc_(2 * 1024 * 1024, 64);
+					auto large_block = allocator.malloc_(512 * 1024);
+					auto stale_mapped = mapped_block, stale_large = large_block;
+					if (!allocator.free_(&mapped_block) || allocator.free_(&stale_mapped) ||
+						!allocator.free_(&large_block) || allocator.free_(&stale_large)) {
+						error |= 结果错误;
+					}
+				}
+				// 析构时应析构并释放所有存活块
+				if (alive != 0) {
+					error |= 结果错误;
+				}
+			}
+
+			// 未初始化存储与区间构造 / 析构
+			{
+				static i32 alive = 0;
+				struct counted {
+					u64 value;
+					counted(u64 value = 0) : value(value) { ++alive; }
+					counted(const counted& other) : value(other.value) { ++alive; }
+					~counted() { --alive; }
+				};
+				system_allocator allocator;
+				auto raw = allocator.allocate_<counted>(8);
+				construct(raw.start, 4, counted(7));
+				construct_copy(raw.start + 4, raw.start, 4);
+				if (alive != 8 || raw.start[7].value != 7) {
+					error |= 结果错误;
+				}
+				destroy(raw);
+				block<u64> wrong_type(reinterpret_cast<u64*>(raw.start), 8);
+				if (alive != 0 || allocator.delete_(raw) || allocator.deallocate_(wrong_type) || !allocator.deallocate_(raw)) {
+					error |= 结果错误;
+				}
+
+				auto values = allocator.allocate_<u32>(1000);
+				construct_zeroed(values.start, values.size);
+				values[999] = 5;
+				auto moved = allocator.allocate_<u32>(1000);
+				relocate(moved.start, values.start, values.size);
+				if (moved[0] != 0 || moved[999] != 5 || !allocator.deallocate_(values) || !allocator.deallocate_(moved)) {
+					error |= 结果错误;
+				}
+			}
+
+			// arena：对齐、回退与复用
+			{
+				arena_allocator arena(1024);
+				auto a = arena.malloc_(10);
+				auto b = arena.malloc_(64, 64);
+				if (reinterpret_cast<uintptr_t>(b.start) % 64 != 0 || b.start < a.start + 10) {
+					error |= 结果错误;
+				}
+				auto position = arena.mark();
+				auto big = arena.new_<u64>(1000); // 超过单个大块容量
+				if (big[999] != 0) {
+					error |= 结果错误;
+				}
+				try {
+					arena.new_<u64>((u64(1) << 61) + 1); // 字节数回绕为 8
+					error |= 结果错误;
+				}
+				catch (const std::bad_alloc&) {
+				}
+				try {
+					arena.malloc_(~0ull - 8); // 加上对齐余量后回绕
+					error |= 结果错误;
+				}
+				catch (const std::bad_alloc&) {
+				}
+				arena.rewind(position);
+				auto c = arena.malloc_(16);
+				if (c.start != memory_allocator::local::align_up(b.start + 64, alignof(std::max_align_t))) {
+					error |= 结果错误;
+				}
+				u64 reserved = arena.get_reserved();
+				arena.reset();
+				for (i32 i = 0; i < 100; ++i) {
+					arena.malloc_(64);
+				}
+				if (arena.get_reserved() != reserved) {
+					error |= 结果错误;
+				}
+			}
+
+			// 对象池：构造、复用与批量操作
+			{
+				struct node {
+					u64 value;
+					node* next;
+				};
+				pool_allocator<node, true> pool;
+				node* first = pool.new_(node{ 7, nullptr });
+				if (first->value != 7 || reinterpret_cast<uintptr_t>(first) % cache_line_size != 0) {
+					error |= 结果错误;
+				}
+				pool.delete_(first);
+				if (pool.allocate() != first) {
+					error |= 结果错误;
+				}
+
+				std::vector<node*> nodes(1000);
+				pool.allocate_bulk(nodes.data(), nodes.size());
+				std::set<node*> unique(nodes.begin(), nodes.end());
+				if (unique.size() != nodes.size() || unique.count(first)) {
+					error |= 结果错误;
+				}
+				u64 slabs = pool.get_slab_count();
+				pool.deallocate_bulk(nodes.data(), nodes.size());
+				pool.allocate_bulk(nodes.data(), nodes.size());
+				if (pool.get_slab_count() != slabs) {
+					error |= 结果错误;
+				}
+			}
+
+			// 线程缓存分配器：尺寸分级、跨线程释放与重复释放检测
+			{
+				for (u32 c = 0; c < caching_allocator::class_count; ++c) {
+					if (caching_allocator::size_to_class(caching_allocator::class_to_size(c)) != c) {
+						error |= 结果错误;
+					}
+				}
+
+				caching_allocator allocator;
+				std::vector<void*> blocks(20000);
+				std::thread producer([&]() {
+					for (size_t i = 0; i < blocks.size(); ++i) {
+						auto b = allocator.malloc_(8 + (i % 64) * 8);
+						std::memset(b.start, 0xAB, b.size);
+						blocks[i] = b.start;
+					}
+					});
+				producer.join();
+				std::thread consumer([&]() {
+					for (auto ptr : blocks) {
+						if (!allocator.free_(ptr)) {
+							error |= 结果错误;
+						}
+					}
+					});
+				consumer.join();
+				if (allocator.free_(blocks[0])) {
+					error |= 结果错误;
+				}
+				auto large = allocator.new_<std::array<u64, 8192>>();
+				if (!allocator.delete_(large)) {
+					error |= 结果错误;
+				}
+				try {
+					allocator.malloc_(~0ull - 8); // 加上块头后回绕
+					error |= 结果错误;
+				}
+				catch (const std::bad_alloc&) {
+				}
+			}
+
+			// 分配统计：多线程计数、标签、峰值与快照
+			{
+				allocation_stats stats("test");
+				u32 decode_tag = allocation_stats::register_tag("decode");
+				if (decode_tag == 0 || allocation_stats::register_tag("decode") != decode_tag) {
+					error |= 结果错误;
+				}
+
+				caching_allocator cache;
+				cache.set_stats(&stats);
+				std::vector<std::thread> threads;
+				for (i32 t = 0; t < 4; ++t) {
+					threads.emplace_back([&cache, decode_tag]() {
+						allocation_stats::tag_scope scope(decode_tag);
+						std::vector<void*> blocks;
+						for (i32 i = 0; i < 1000; ++i) {
+							blocks.push_back(cache.malloc_(100).start);
+						}
+						for (auto ptr : blocks) {
+							cache.free_(ptr);
+						}
+						});
+				}
+				for (auto& thread : threads) {
+					thread.join();
+				}
+				pool_allocator<u64> pool;
+				pool.set_stats(&stats);
+				u64* kept = pool.allocate();
+
+				auto snapshot = stats.snapshot();
+				u64 usable = caching_allocator::class_to_size(caching_allocator::size_to_class(100 + caching_allocator::header_size)) - caching_allocator::header_size;
+				if (snapshot.total.allocations != 4001 || snapshot.total.frees != 4000 ||
+					snapshot.total.live_bytes() != static_cast<i64>(sizeof(u64)) ||
+					snapshot.total.histogram[std::bit_width(usable)] != 4000 ||
+					snapshot.peak_bytes + allocation_stats::peak_flush_bytes < 1000 * usable || snapshot.tags.size() != 2 ||
+					snapshot.to_json().find("\"tag\": \"decode\"") == std::string::npos ||
+					snapshot.to_text().find("decode") == std::string::npos) {
+					error |= 结果错误;
+				}
+				pool.deallocate(kept);
+
+				// 泄漏报告列出存活块
+				system_allocator system;
+				system.set_stats(&stats);
+				auto leaked = system.malloc_(48);
+				auto freed = system.new_<u32>(4);
+				system.delete_(freed);
+				try {
+					system.new_<u32>((u64(1) << 62) + 1); // 字节数回绕为 4
+					error |= 结果错误;
+				}
+				catch (const std::bad_alloc&) {
+				}
+				// 加上块头后回绕的请求
+				if (system.malloc_(~0ull - 8).start) {
+					error |= 结果错误;
+				}
+				try {
+					system.new_<byte>(~0ull - 8);
+					error |= 结果错误;
+				}
+				catch (const std::bad_alloc&) {
+				}
+				try {
+					system.allocate_<byte>(~0ull - 8);
+					error |= 结果错误;
+				}
+				catch (const std::bad_alloc&) {
+				}
+				auto report = system.leak_report();
+				if (report.find("1 live blocks, 48 B") == std::string::npos) {
+					error |= 结果错误;
+				}
+				system.free_(&leaked);
+			}
+
+			// 伙伴分配器：拆分、合并与碎片统计
+			{
+				buddy_allocator buddy(1024 * 1024, 64);
+				auto a = buddy.malloc_(100);
+				auto b = buddy.malloc_(64);
+				auto c = buddy.malloc_(5000);
+				if (!a.start || !b.start || !c.start || buddy.block_size(100) != 128 ||
+					reinterpret_cast<uintptr_t>(c.start) % 4096 != 0 ||
+					buddy.get_free_bytes() != buddy.get_capacity() - 128 - 64 - 8192 ||
+					buddy.malloc_(2 * 1024 * 1024).start) {
+					error |= 结果错误;
+				}
+				if (buddy.get_largest_free_block() != 512 * 1024 || buddy.get_fragmentation() <= 0) {
+					error |= 结果错误;
+				}
+				if (!buddy.free_(&a) || !buddy.free_(&b) || !buddy.free_(&c) || buddy.free_(&c)) {
+					error |= 结果错误;
+				}
+				// 全部释放后应合并回一整块
+				if (buddy.get_largest_free_block() != buddy.get_capacity() || buddy.get_fragmentation() != 0) {
+					error |= 结果错误;
+				}
+
+				buddy_resource buddy_res(buddy);
+				{
+					std::pmr::vector<u64> values(&buddy_res);
+					for (u64 i = 0; i < 10000; ++i) {
+						values.push_back(i);
+					}
+				}
+				if (buddy.get_free_bytes() != buddy.get_capacity()) {
+					error |= 结果错误;
+				}
+			}
+
+			// pmr 适配器：标准容器经由各分配器分配，超出能力的请求转交 upstream
+			{
+				arena_allocator arena;
+				arena_resource arena_res(arena);
+				{
+					auto parts = tools::string::split_by_special_string(U"aa@@bb@@cc", U"@@", &arena_res);
+					if (parts.size() != 3 || parts[2] != U"cc" || arena.get_used() == 0) {
+						error |= 结果错误;
+					}
+				}
+
+				pool_allocator<std::array<u64, 4>> pool;
+				pool_resource<std::array<u64, 4>> pool_res(pool, std::pmr::null_memory_resource());
+				{
+					std::pmr::list<u64> values(&pool_res);
+					for (u64 i = 0; i < 1000; ++i) {
+						values.push_back(i);
+					}
+					if (values.size() != 1000 || pool.get_slab_count() == 0) {
+						error |= 结果错误;
+					}
+				}
+
+				caching_allocator cache;
+				caching_resource cache_res(cache);
+				system_allocator system;
+				system_resource system_res(system);
+				system_resource upstream_res(system, std::pmr::new_delete_resource());
+				for (std::pmr::memory_resource* resource : { static_cast<std::pmr::memory_resource*>(&cache_res), static_cast<std::pmr::memory_resource*>(&system_res),
+					static_cast<std::pmr::memory_resource*>(&upstream_res) }) {
+					std::pmr::vector<std::pmr::string> strings(resource);
+					for (i32 i = 0; i < 100; ++i) {
+						strings.emplace_back(std::string(64, 'a' + i % 26));
+					}
+					void* aligned = resource->allocate(256, 128);
+					if (strings[99][0] != 'a' + 99 % 26 || reinterpret_cast<uintptr_t>(aligned) % 128 != 0) {
+						error |= 结果错误;
+					}
+					resource->deallocate(aligned, 256, 128);
+				}
+				if (system_res.upstream_resource() || upstream_res.upstream_resource() != std::pmr::new_delete_resource()) {
+					error |= 结果错误;
+				}
+			}
+			return error;
 		}
 #endif tools_debug
 	}
-}
\ No newline at end of file
+}
@@ -1,5 +1,15 @@
 #pragma once
 #include "../tools.hpp"
+#include "./threaded_data_container.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+#include <new>
+#include <mutex>
+#include <memory_resource>
+#include <string_view>
+
 namespace tools {
 	namespace memory_allocator {
 		// 用于管理内存块的块类
@@ -25,47 +35,306 @@ namespace tools {
 			u64 size;  // 块的大小
 		};
 
+		// 以下函数在未初始化存储上构造 / 析构元素区间，可平凡复制的类型走 memset / memcpy 批量路径
+
+		// 在 [ptr, ptr + count) 上构造 T(args...)；无参数时默认初始化，可平凡默认构造的类型不做任何事
+		template<typename T, typename... Args>
+		void construct(T* ptr, u64 count, const Args&... args) {
+			if constexpr (sizeof...(Args) == 0) {
+				std::uninitialized_default_construct_n(ptr, count);
+			}
+			else {
+				std::uninitialized_fill_n(ptr, count, T(args...));
+			}
+		}
+
+		// 值初始化 [ptr, ptr + count)，可平凡构造的类型直接清零
+		template<typename T>
+		void construct_zeroed(T* ptr, u64 count) {
+			if constexpr (std::is_trivially_default_constructible_v<T> && std::is_trivially_copyable_v<T>) {
+				std::memset(static_cast<void*>(ptr), 0, count * sizeof(T));
+			}
+			else {
+				std::uninitialized_value_construct_n(ptr, count);
+			}
+		}
+
+		// 将 src 的 count 个元素拷贝构造到未初始化的 dst，两者不能重叠
+		template<typename T>
+		void construct_copy(T* dst, const T* src, u64 count) {
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
+			}
+			else {
+				std::uninitialized_copy_n(src, count, dst);
+			}
+		}
+
+		// 将 src 的 count 个元素移动到未初始化的 dst 并析构 src，之后 src 为未初始化存储
+		template<typename T>
+		void relocate(T* dst, T* src, u64 count) {
+			if constexpr (std::is_trivially_copyable_v<T>) {
+				std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
+			}
+			else {
+				std::uninitialized_move_n(src, count, dst);
+				std::destroy_n(src, count);
+			}
+		}
+
+		// 析构 [ptr, ptr + count)，可平凡析构的类型不做任何事
+		template<typename T>
+		void destroy(T* ptr, u64 count) {
+			if constexpr (!std::is_trivially_destructible_v<T>) {
+				std::destroy_n(ptr, count);
+			}
+		}
+
+		// 对整个块构造 / 析构
+		template<typename T, typename... Args>
+		void construct(block<T>& b, const Args&... args) {
+			construct(b.start, b.size, args...);
+		}
+
+		template<typename T>
+		void destroy(block<T>& b) {
+			destroy(b.start, b.size);
+		}
+
+		// 一组分配计数。histogram 第 i 桶统计大小在 [2^(i-1), 2^i) 的分配次数，0 字节计入第 0 桶
+		struct allocation_counters {
+			static constexpr u32 histogram_buckets = 32;
+
+			u64 allocations = 0;
+			u64 frees = 0;
+			u64 allocated_bytes = 0;
+			u64 freed_bytes = 0;
+			u64 histogram[histogram_buckets] = {};
+
+			// 存活字节数，跨线程或跨标签释放时单个分组可能为负
+			i64 live_bytes() const {
+				return static_cast<i64>(allocated_bytes - freed_bytes);
+			}
+
+			allocation_counters& operator+=(const allocation_counters& other);
+		};
+
+		// allocation_stats 的快照
+		struct allocation_snapshot {
+			std::string name;
+			allocation_counters total;
+			u64 peak_bytes = 0;
+			std::vector<std::pair<std::string, allocation_counters>> tags;	// 只包含有记录的标签
+
+			std::string to_text() const;
+			std::string to_json() const;
+		};
+
+		class allocation_stats;
+
+		namespace local {
+			// 每个线程一份的计数，只由所属线程写入
+			struct stats_record;
+
+			// 线程退出时将计数记录交还给仍存活的统计对象
+			struct stats_registrations {
+				std::vector<std::pair<u64, stats_record*>> entries;
+				~stats_registrations();
+			};
+		}
+
+		// 分配统计（可选）：通过分配器的 set_stats 挂接，未挂接时分配器只多一次空指针判断。
+		// 计数按线程分片，记录时不需要原子读改写；峰值按线程累计超过 peak_flush_bytes 的变化才合并，
+		// 误差不超过 线程数 * peak_flush_bytes。标签为全局的调用点名称，通过 tag_scope 对当前线程生效。
+		class allocation_stats {
+		public:
+			static constexpr u32 max_tags = 32;
+			static constexpr u64 peak_flush_bytes = 64 * 1024;
+
+			// 注册调用点标签，同名返回同一编号；编号 0 表示未标记，标签数超过 max_tags 时返回 0
+			static u32 register_tag(std::string_view name);
+
+			// 当前线程的标签
+			static u32 current_tag();
+
+			// 标签编号对应的名称
+			static std::string tag_name(u32 tag);
+
+			// 作用域内当前线程的分配记入 tag，可嵌套
+			class tag_scope {
+			public:
+				explicit tag_scope(u32 tag);
+				~tag_scope();
+
+				tag_scope(const tag_scope&) = delete;
+				tag_scope& operator=(const tag_scope&) = delete;
+
+			private:
+				u32 previous_;
+			};
+
+			explicit allocation_stats(std::string name = "");
+			~allocation_stats();
+
+			allocation_stats(const allocation_stats&) = delete;
+			allocation_stats& operator=(const allocation_stats&) = delete;
+
+			// 记录 count 次大小为 bytes 的分配 / 释放
+			void record_allocate(u64 bytes, u64 count = 1, u32 tag = current_tag());
+			void record_free(u64 bytes, u64 count = 1, u32 tag = current_tag());
+
+			// 汇总所有线程的计数
+			allocation_snapshot snapshot() const;
+
+			const std::string& get_name() const {
+				return name_;
+			}
+
+		private:
+			friend struct local::stats_registrations;
+
+			local::stats_record* get_record();
+			void release_record(local::stats_record* record);
+			void add_live(i64 delta);
+
+			std::string name_;
+			u64 id_;
+			std::atomic<local::stats_record*> records_{ nullptr };
+			std::atomic<i64> live_{ 0 };
+			std::atomic<i64> peak_{ 0 };
+		};
+
+		namespace local {
+			// system_allocator 的块头，紧邻数据区之前；块之间以侵入式双向链表串联，
+			// 释放时 O(1) 摘除，不需要额外分配也不需要哈希查找
+			struct system_header {
+				system_header* prev;
+				system_header* next;
+				const void* owner;					// 分配该块的 system_allocator
+				const void* type;					// 元素类型标识，malloc_ 分配时为 nullptr
+				void (*destroy)(void*, u64);		// 元素析构函数，可平凡析构时为 nullptr
+				u64 size;							// 数据区字节数
+				u32 offset;							// 分配起点到数据区的偏移
+				u32 alignment;						// 分配时使用的对齐
+				u32 magic;							// 分配方式与存活状态
+				u16 mapped;							// 非 0 表示数据区直接映射自操作系统页面
+				u16 tag;							// 分配时的统计标签
+			};
+
+			// 操作系统页面大小
+			u64 page_size();
+
+			// 向操作系统申请 / 归还匿名页面，失败时返回 nullptr
+			byte* map_pages(u64 bytes, bool huge_pages);
+			void unmap_pages(byte* base, u64 bytes);
+
+			// 每个类型唯一的地址，用作类型标识
+			template<typename T>
+			const void* type_tag() {
+				static const char tag = 0;
+				return &tag;
+			}
+		}
+
+		// 透明大页的大小（x86-64 与 AArch64 4K 页配置下均为 2 MiB）
+		inline constexpr u64 huge_page_size = 2 * 1024 * 1024;
+
+		// 大块分配选项
+		struct page_options {
+			u64 map_threshold = 1024 * 1024;	// 不小于该字节数的请求直接向操作系统映射页面
+			bool huge_pages = false;			// 建议内核以透明大页支撑（Linux MADV_HUGEPAGE），数据区按大页对齐
+			bool prefault = false;				// 分配时预先触碰所有页面，避免首次访问时缺页
+		};
+
+		// 系统分配器：每个块带有块头，记录归属、分配方式与类型，释放时校验后 O(1) 归还。
+		// 释放后块指针会被置空；对过期副本的重复释放，映射块与大块通过存活表检测，其余块依赖块头魔数，只能尽力而为。
+		// 非线程安全。
 		class system_allocator {
 		public:
-			// 分配指定大小的原始内存
+			// 分配指定大小的原始内存，失败时返回 start 为 nullptr 的块
 			block<byte> malloc_(u64 size) {
-				auto block_ = (byte*)std::malloc(size);
-				if (block_) {
-					memory_pool.insert({ block_, MemoryType::Malloc });
+				auto header = allocate_header(size, alignof(std::max_align_t), std::nothrow);
+				if (!header) {
+					return block<byte>(nullptr, size);
 				}
-				return block<byte>(block_, size);
+				header->magic = malloc_magic;
+				return block<byte>(data_of<byte>(header), size);
 			}
 
+			// 按指定对齐（2 的幂，如 O_DIRECT 要求的 4096）分配原始内存，失败时返回 start 为 nullptr 的块。
+			// 不小于 options.map_threshold 的请求直接映射操作系统页面，可选透明大页与预缺页。
+			block<byte> malloc_(u64 size, u64 alignment, page_options options = {});
+
 			// 释放通过 `malloc_` 分配的内存
 			bool free_(block<byte>* block) {
-				auto it = memory_pool.find(block->start);  // 使用 start 而不是 obj
-				if (it != memory_pool.end() && it->second == MemoryType::Malloc) {
-					memory_pool.erase(it);
-					std::free(block->start);  // 使用 std::free 释放内存
-					return true;
+				auto header = check(block->start, block->size, 1, malloc_magic, nullptr);
+				if (!header) {
+					return false;
 				}
-				return false;
+				release(header);
+				block->start = nullptr;  // 避免重复释放
+				block->size = 0;
+				return true;
 			}
 
-			// 分配一个类型为 T 的内存块，并返回该内存块的信息
+			// 分配一个类型为 T 的内存块并默认构造每个元素，失败时抛出 std::bad_alloc
 			template<typename T>
 			block<T> new_(u64 size) {
-				T* block_ = new T[size];  // 使用 new[] 分配内存
-				if (block_) {
-					memory_pool.insert({ (byte*)block_, MemoryType::New });
+				if (size > std::numeric_limits<u64>::max() / sizeof(T)) {
+					throw std::bad_alloc();
+				}
+				auto header = allocate_header(size * sizeof(T), alignof(T));
+				T* start = data_of<T>(header);
+				try {
+					std::uninitialized_default_construct_n(start, size);
+				}
+				catch (...) {
+					release(header);
+					throw;
+				}
+				header->magic = new_magic;
+				header->type = local::type_tag<T>();
+				if constexpr (!std::is_trivially_destructible_v<T>) {
+					header->destroy = [](void* p, u64 bytes) { std::destroy_n(static_cast<T*>(p), bytes / sizeof(T)); };
+				}
+				return block<T>(start, size);  // 返回 block 对象，包含分配的内存块和大小
+			}
+
+			// 分配 size 个 T 的未初始化存储，不构造任何元素，失败时抛出 std::bad_alloc。
+			// 元素由调用方通过 construct / destroy 管理，分配器析构时不会析构其中的元素
+			template<typename T>
+			block<T> allocate_(u64 size) {
+				if (size > std::numeric_limits<u64>::max() / sizeof(T)) {
+					throw std::bad_alloc();
 				}
-				return block<T>(block_, size);  // 返回 block 对象，包含分配的内存块和大小
+				auto header = allocate_header(size * sizeof(T), alignof(T));
+				header->magic = raw_magic;
+				header->type = local::type_tag<T>();
+				return block<T>(data_of<T>(header), size);
 			}
 
-			// 释放通过 `new[]` 分配的内存
+			// 释放通过 `allocate_` 分配的存储，不析构元素
+			template<typename T>
+			bool deallocate_(block<T>& b) {
+				auto header = check(b.start, b.size, sizeof(T), raw_magic, local::type_tag<T>());
+				if (!header) {
+					return false;
+				}
+				release(header);
+				b.start = nullptr;
+				b.size = 0;
+				return true;
+			}
+
+			// 析构并释放通过 `new_` 分配的内存
 			template<typename T>
 			bool delete_(block<T>& b) {
 				if (b.start) {
-					// 确保该内存块在 memory_pool 中并且是通过 `new[]` 分配的
-					auto it = memory_pool.find((byte*)b.start);
-					if (it != memory_pool.end() && it->second == MemoryType::New) {
-						delete[] b.start;  // 使用 delete[] 释放内存
-						memory_pool.erase(it);  // 从 memory_pool 中移除
+					// 确保该内存块属于本分配器、通过 `new_` 分配且类型一致
+					auto header = check(b.start, b.size, sizeof(T), new_magic, local::type_tag<T>());
+					if (header) {
+						std::destroy_n(b.start, header->size / sizeof(T));
+						release(header);
 						b.start = nullptr;  // 避免重复释放
 						b.size = 0;  // 重置大小
 						return true;
@@ -74,31 +343,846 @@ namespace tools {
 				return false;
 			}
 
-			// 构造函数
-			system_allocator() {
-				memory_pool.reserve(256);  // 为 unordered_map 预留 256 个空间（提高效率）
+			system_allocator() = default;
+
+			system_allocator(const system_allocator&) = delete;
+			system_allocator& operator=(const system_allocator&) = delete;
+
+			// 挂接分配统计，nullptr 表示不统计；应在分配前设置
+			void set_stats(allocation_stats* stats) {
+				stats_ = stats;
 			}
 
-			// 析构函数，释放池中所有已分配的内存
+			allocation_stats* get_stats() const {
+				return stats_;
+			}
+
+			// 列出所有仍存活的块：地址、字节数、分配方式与标签
+			std::string leak_report(u64 max_blocks = 32) const;
+
+			// 析构函数，释放所有仍存活的内存块（new_ 分配的元素会先析构）。
+			// 挂接了统计时，先将存活块作为泄漏报告输出到 std::cerr
 			~system_allocator() {
-				for (auto& entry : memory_pool) {
-					if (entry.second == MemoryType::Malloc) {
-						std::free(entry.first);  // 使用 free 释放 malloc 分配的内存
+				if (stats_ && head_) {
+					std::cerr << leak_report();
+				}
+				while (head_) {
+					auto header = head_;
+					if (header->destroy) {
+						header->destroy(data_of<byte>(header), header->size);
 					}
-					else if (entry.second == MemoryType::New) {
-						delete[] entry.first;  // 使用 delete[] 释放 new[] 分配的内存
+					release(header);
+				}
+			}
+
+		private:
+			static constexpr u32 malloc_magic = 0x6D616C6C;	// 存活的 malloc_ 块
+			static constexpr u32 new_magic = 0x6E65775F;		// 存活的 new_ 块
+			static constexpr u32 raw_magic = 0x72617721;		// 存活的 allocate_ 块
+			static constexpr u32 freed_magic = 0xDEADF7EE;		// 已释放
+
+			template<typename T>
+			static T* data_of(local::system_header* header) {
+				return reinterpret_cast<T*>(header + 1);
+			}
+
+			static local::system_header* header_of(const void* ptr) {
+				return reinterpret_cast<local::system_header*>(const_cast<void*>(ptr)) - 1;
+			}
+
+			// 分配块头与数据区，块头紧邻数据区之前，并挂入存活链表
+			template<typename... Nothrow>
+			local::system_header* allocate_header(u64 bytes, u64 alignment, Nothrow... nothrow) {
+				alignment = std::max<u64>(alignment, alignof(local::system_header));
+				u64 offset = (sizeof(local::system_header) + alignment - 1) / alignment * alignment;
+				byte* base = nullptr;
+				if (bytes <= std::numeric_limits<u64>::max() - offset) {
+					// 默认对齐足够时使用普通 operator new，对齐分配在多数平台上更慢
+					base = static_cast<byte*>(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__
+						? ::operator new(offset + bytes, nothrow...)
+						: ::operator new(offset + bytes, std::align_val_t(alignment), nothrow...));
+					if (base && !track(base + offset, bytes)) {
+						delete_base(base, alignment);
+						base = nullptr;
+					}
+				}
+				if (!base) {
+					if constexpr (sizeof...(Nothrow) > 0) {
+						return nullptr;
 					}
+					else {
+						throw std::bad_alloc();
+					}
+				}
+				auto header = reinterpret_cast<local::system_header*>(base + offset) - 1;
+				header->owner = this;
+				header->type = nullptr;
+				header->destroy = nullptr;
+				header->offset = static_cast<u32>(offset);
+				header->alignment = static_cast<u32>(alignment);
+				header->mapped = 0;
+				link(header, bytes);
+				return header;
+			}
+
+			// 直接映射页面并放置块头，数据区按 alignment 且至少按页对齐，块头位于数据区前一页的末尾
+			local::system_header* map_header(u64 bytes, u64 alignment, bool huge_pages);
+
+			// 映射块占用的页面字节数，只取决于数据大小与对齐
+			static u64 mapped_bytes(u64 bytes, u64 alignment) {
+				u64 page = local::page_size();
+				u64 total = std::max<u64>(alignment, page) + bytes;
+				return (total + page - 1) / page * page;
+			}
+
+			// 不小于该字节数的块可能由 C 运行库单独映射，释放后块头所在页面可能已归还系统
+			static constexpr u64 tracked_bytes = 64 * 1024;
+
+			// 数据区按页对齐（所有映射块）或足够大的块记录在 tracked_ 中，释放时先查表，不读取可能已失效的块头
+			static bool needs_tracking(const void* ptr, u64 count, u64 element_size) {
+				return count >= (tracked_bytes + element_size - 1) / element_size
+					|| reinterpret_cast<uintptr_t>(ptr) % local::page_size() == 0;
+			}
+
+			// 按需记入 tracked_，内存不足时返回 false
+			bool track(const void* data, u64 bytes) {
+				if (!needs_tracking(data, bytes, 1)) {
+					return true;
 				}
+				try {
+					tracked_.insert(data);
+					return true;
+				}
+				catch (const std::bad_alloc&) {
+					return false;
+				}
+			}
+
+			static void delete_base(byte* base, u64 alignment) {
+				if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+					::operator delete(base);
+				}
+				else {
+					::operator delete(base, std::align_val_t(alignment));
+				}
+			}
+
+			// 挂入存活链表并记入统计
+			void link(local::system_header* header, u64 bytes) {
+				header->size = bytes;
+				header->tag = 0;
+				if (stats_) {
+					header->tag = static_cast<u16>(allocation_stats::current_tag());
+					stats_->record_allocate(bytes, 1, header->tag);
+				}
+				header->prev = nullptr;
+				header->next = head_;
+				if (head_) {
+					head_->prev = header;
+				}
+				head_ = header;
 			}
 
+			// 校验块头：属于本分配器、分配方式与类型一致且未被释放。count 个 element_size 字节的元素为调用方记录的块大小
+			local::system_header* check(const void* ptr, u64 count, u64 element_size, u32 magic, const void* type) const {
+				if (!ptr || (needs_tracking(ptr, count, element_size) && !tracked_.contains(ptr))) {
+					return nullptr;
+				}
+				auto header = header_of(ptr);
+				if (header->magic != magic || header->owner != this || header->type != type) {
+					return nullptr;
+				}
+				return header;
+			}
+
+			// 从存活链表摘除并归还系统
+			void release(local::system_header* header) {
+				if (header->prev) {
+					header->prev->next = header->next;
+				}
+				else {
+					head_ = header->next;
+				}
+				if (header->next) {
+					header->next->prev = header->prev;
+				}
+				header->magic = freed_magic;
+				if (stats_) {
+					stats_->record_free(header->size, 1, header->tag);
+				}
+				auto data = data_of<byte>(header);
+				if (needs_tracking(data, header->size, 1)) {
+					tracked_.erase(data);
+				}
+				auto base = data - header->offset;
+				if (header->mapped) {
+					local::unmap_pages(base, mapped_bytes(header->size, header->alignment));
+				}
+				else {
+					delete_base(base, header->alignment);
+				}
+			}
+
+			// 所有存活内存块组成的链表
+			local::system_header* head_ = nullptr;
+			// 需要查表校验的存活块数据区地址
+			std::unordered_set<const void*> tracked_;
+			allocation_stats* stats_ = nullptr;
+		};
+
+		namespace local {
+			// 将地址向上对齐到 alignment（必须为 2 的幂）
+			inline byte* align_up(byte* ptr, u64 alignment) {
+				return reinterpret_cast<byte*>((reinterpret_cast<uintptr_t>(ptr) + (alignment - 1)) & ~uintptr_t(alignment - 1));
+			}
+
+			// arena 的内存块头，数据紧随其后
+			struct alignas(std::max_align_t) arena_chunk {
+				arena_chunk* next;
+				byte* end;
+
+				byte* data() {
+					return reinterpret_cast<byte*>(this + 1);
+				}
+			};
+		}
+
+		// 线性（bump-pointer）分配器
+		// 从链式大块中顺序切出内存，单次分配只移动指针；不支持单独释放，
+		// 通过 rewind 回退到标记点、reset 整体复用或 release / 析构一次性释放。
+		// 不会调用对象的析构函数，因此 new_ 只接受可平凡析构的类型。
+		class arena_allocator {
+		public:
+			// 回退标记，记录分配位置
+			struct marker {
+				local::arena_chunk* chunk;
+				byte* top;
+				u64 recorded;	// 标记时已记入统计的字节数
+			};
+
+			// chunk_size: 每个大块的默认容量（字节）
+			arena_allocator(u64 chunk_size = 64 * 1024);
+			~arena_allocator();
+
+			arena_allocator(const arena_allocator&) = delete;
+			arena_allocator& operator=(const arena_allocator&) = delete;
+
+			// 分配指定大小和对齐的原始内存，失败时抛出 std::bad_alloc
+			inline block<byte> malloc_(u64 size, u64 alignment = alignof(std::max_align_t)) {
+				byte* aligned = local::align_up(top_, alignment);
+				if (top_ && aligned <= end_ && size <= static_cast<u64>(end_ - aligned)) {
+					top_ = aligned + size;
+				}
+				else {
+					aligned = allocate_slow(size, alignment);
+				}
+				if (stats_) {
+					record_allocate(size);
+				}
+				return block<byte>(aligned, size);
+			}
+
+			// 分配 size 个值初始化的 T
+			template<typename T>
+			block<T> new_(u64 size) {
+				static_assert(std::is_trivially_destructible_v<T>, "arena_allocator never runs destructors");
+				if (size > std::numeric_limits<u64>::max() / sizeof(T)) {
+					throw std::bad_alloc();
+				}
+				auto raw = malloc_(size * sizeof(T), alignof(T));
+				T* start = reinterpret_cast<T*>(raw.start);
+				std::uninitialized_value_construct_n(start, size);
+				return block<T>(start, size);
+			}
+
+			// 记录当前分配位置
+			marker mark() const {
+				return { current_, top_, recorded_ };
+			}
+
+			// 回退到标记点，之后分配的内存全部失效
+			void rewind(marker position);
+
+			// 回到第一个大块，保留所有大块供复用，O(1)
+			void reset();
+
+			// 挂接分配统计，nullptr 表示不统计；rewind / reset / release 各记为一次释放
+			void set_stats(allocation_stats* stats) {
+				stats_ = stats;
+			}
+
+			allocation_stats* get_stats() const {
+				return stats_;
+			}
+
+			// 释放所有大块
+			void release();
+
+			// 当前大块之前（含当前大块）已使用的字节数
+			u64 get_used() const;
+
+			// 已向系统申请的总字节数
+			u64 get_reserved() const;
+
 		private:
-			enum class MemoryType {
-				Malloc,
-				New
+			byte* allocate_slow(u64 size, u64 alignment);
+			void enter_chunk(local::arena_chunk* chunk);
+			void record_allocate(u64 size);
+			void record_rewind(u64 recorded);
+
+			u64 chunk_size_;
+			local::arena_chunk* head_ = nullptr;	// 第一个大块
+			local::arena_chunk* current_ = nullptr;	// 正在分配的大块
+			byte* top_ = nullptr;					// 当前大块的分配位置
+			byte* end_ = nullptr;					// 当前大块的结束位置
+			allocation_stats* stats_ = nullptr;
+			u64 recorded_ = 0;						// 已记入统计且尚未回收的字节数
+		};
+
+		// 缓存行大小
+		inline constexpr u64 cache_line_size = 64;
+
+		// 定长对象池分配器
+		// 以页大小的 slab 为单位向系统申请内存，空闲槽位通过侵入式单链表串联，分配与释放均为 O(1)。
+		// 返回的是未初始化的存储，只有 new_ 才会构造 T。非线程安全。
+		// cache_line_aligned 为 true 时每个槽位独占缓存行，避免相邻对象的伪共享。
+		template<typename T, bool cache_line_aligned = false>
+		class pool_allocator {
+			struct free_node {
+				free_node* next;
 			};
 
-			// 用于存储所有已分配内存块的池，记录每个内存块的类型
-			std::unordered_map<byte*, MemoryType> memory_pool;
+		public:
+			// 槽位对齐与大小
+			static constexpr u64 slot_alignment = std::max<u64>({ alignof(T), alignof(free_node), cache_line_aligned ? cache_line_size : 1 });
+			static constexpr u64 slot_size = (std::max<u64>(sizeof(T), sizeof(free_node)) + slot_alignment - 1) / slot_alignment * slot_alignment;
+
+			// slab_size: 每个 slab 的字节数，向上取整为 4096 的倍数且至少容纳 8 个槽位
+			pool_allocator(u64 slab_size = 4096) {
+				u64 minimum = std::max<u64>(slab_size, slot_size * 8);
+				slab_size_ = (minimum + 4095) / 4096 * 4096;
+			}
+
+			// 析构时释放所有 slab，不会调用仍存活对象的析构函数
+			~pool_allocator() {
+				release();
+			}
+
+			pool_allocator(const pool_allocator&) = delete;
+			pool_allocator& operator=(const pool_allocator&) = delete;
+
+			// 分配一个未初始化的槽位
+			inline T* allocate() {
+				byte* slot;
+				if (free_list_) {
+					auto node = free_list_;
+					free_list_ = node->next;
+					slot = reinterpret_cast<byte*>(node);
+				}
+				else {
+					if (bump_ == bump_end_) {
+						add_slab();
+					}
+					slot = bump_;
+					bump_ += slot_size;
+				}
+				// 取得槽位后再计数，add_slab 抛出时统计不受影响
+				if (stats_) {
+					stats_->record_allocate(slot_size);
+				}
+				return reinterpret_cast<T*>(slot);
+			}
+
+			// 归还槽位，不调用析构函数
+			inline void deallocate(T* ptr) {
+				if (!ptr) {
+					return;
+				}
+				if (stats_) {
+					stats_->record_free(slot_size);
+				}
+				auto node = reinterpret_cast<free_node*>(ptr);
+				node->next = free_list_;
+				free_list_ = node;
+			}
+
+			// 分配并构造一个 T
+			template<typename... Args>
+			T* new_(Args&&... args) {
+				T* slot = allocate();
+				try {
+					return new (slot) T(std::forward<Args>(args)...);
+				}
+				catch (...) {
+					deallocate(slot);
+					throw;
+				}
+			}
+
+			// 析构并归还一个 T
+			void delete_(T* ptr) {
+				if (!ptr) {
+					return;
+				}
+				ptr->~T();
+				deallocate(ptr);
+			}
+
+			// 批量分配 count 个未初始化槽位到 out；add_slab 抛出时已取得的槽位全部归还，统计不变
+			void allocate_bulk(T** out, u64 count) {
+				u64 i = 0;
+				for (; i < count && free_list_; ++i) {
+					out[i] = reinterpret_cast<T*>(free_list_);
+					free_list_ = free_list_->next;
+				}
+				while (i < count) {
+					if (bump_ == bump_end_) {
+						try {
+							add_slab();
+						}
+						catch (...) {
+							while (i > 0) {
+								auto node = reinterpret_cast<free_node*>(out[--i]);
+								node->next = free_list_;
+								free_list_ = node;
+							}
+							throw;
+						}
+					}
+					u64 available = static_cast<u64>(bump_end_ - bump_) / slot_size;
+					u64 take = std::min(available, count - i);
+					for (u64 j = 0; j < take; ++j, ++i) {
+						out[i] = reinterpret_cast<T*>(bump_);
+						bump_ += slot_size;
+					}
+				}
+				if (stats_ && count > 0) {
+					stats_->record_allocate(slot_size, count);
+				}
+			}
+
+			// 批量归还 count 个槽位，一次性接入空闲链表
+			void deallocate_bulk(T** ptrs, u64 count) {
+				free_node* head = free_list_;
+				u64 freed = 0;
+				for (u64 i = 0; i < count; ++i) {
+					if (!ptrs[i]) {
+						continue;
+					}
+					auto node = reinterpret_cast<free_node*>(ptrs[i]);
+					node->next = head;
+					head = node;
+					++freed;
+				}
+				free_list_ = head;
+				if (stats_ && freed > 0) {
+					stats_->record_free(slot_size, freed);
+				}
+			}
+
+			// 释放所有 slab，之前分配的槽位全部失效
+			void release() {
+				for (auto slab : slabs_) {
+					::operator delete(slab, std::align_val_t(slab_alignment));
+				}
+				slabs_.clear();
+				free_list_ = nullptr;
+				bump_ = bump_end_ = nullptr;
+			}
+
+			// 已申请的 slab 数量
+			u64 get_slab_count() const {
+				return slabs_.size();
+			}
+
+			// 每个 slab 容纳的槽位数量
+			u64 get_slots_per_slab() const {
+				return slab_size_ / slot_size;
+			}
+
+			// 挂接分配统计，nullptr 表示不统计；每个槽位按 slot_size 计
+			void set_stats(allocation_stats* stats) {
+				stats_ = stats;
+			}
+
+			allocation_stats* get_stats() const {
+				return stats_;
+			}
+
+		private:
+			static constexpr u64 slab_alignment = std::max<u64>(slot_alignment, alignof(std::max_align_t));
+
+			void add_slab() {
+				slabs_.reserve(slabs_.size() + 1);	// 先预留，push_back 不会在申请 slab 之后抛出
+				auto slab = static_cast<byte*>(::operator new(slab_size_, std::align_val_t(slab_alignment)));
+				slabs_.push_back(slab);
+				bump_ = slab;
+				bump_end_ = slab + get_slots_per_slab() * slot_size;
+			}
+
+			u64 slab_size_;
+			free_node* free_list_ = nullptr;	// 空闲槽位链表
+			byte* bump_ = nullptr;				// 最新 slab 中尚未切分的位置
+			byte* bump_end_ = nullptr;
+			std::vector<byte*> slabs_;
+			allocation_stats* stats_ = nullptr;
+		};
+
+		class caching_allocator;
+
+		namespace local {
+			// 线程缓存分配器的块头，紧邻用户数据之前
+			struct alignas(16) cached_header {
+				u32 size_class;
+				u32 magic;
+				union {
+					void* owner;		// 分配该块的线程缓存
+					u64 large_size;		// 大块的请求字节数
+				};
+			};
+
+			// 空闲块通过用户数据区串联
+			struct cached_free_block {
+				cached_free_block* next;
+			};
+
+			struct thread_cache;
+
+			// 线程退出时将缓存归还给仍存活的分配器
+			struct thread_cache_registrations {
+				std::vector<std::pair<u64, thread_cache*>> entries;
+				~thread_cache_registrations();
+			};
+		}
+
+		// 线程缓存分配器（tcmalloc 风格）
+		// 小块按尺寸分级，每个线程持有各级的本地空闲链表，无锁分配与释放；
+		// 本地链表为空时从按尺寸分片的中心仓库批量补充，过长时批量归还。
+		// 其他线程释放的块先在释放线程攒批，再一次 CAS 挂到所属线程缓存的远程链表上。
+		// 超过 max_small_size 的请求直接使用 std::malloc。线程安全。
+		class caching_allocator {
+		public:
+			static constexpr u64 header_size = sizeof(local::cached_header);
+			static constexpr u64 max_small_size = 32 * 1024;
+			static constexpr u32 class_count = 40;
+			static constexpr u32 large_class = 0xFFFF;
+
+			caching_allocator();
+
+			// 析构时释放所有内存，之后仍在使用的块全部失效
+			~caching_allocator();
+
+			caching_allocator(const caching_allocator&) = delete;
+			caching_allocator& operator=(const caching_allocator&) = delete;
+
+			// 分配原始内存（16 字节对齐），失败时抛出 std::bad_alloc
+			block<byte> malloc_(u64 size);
+
+			// 释放通过 `malloc_` 分配的内存，ptr 为空时返回 false。
+			// 归属由紧邻数据区之前的块头判断，不查找 span 区间以免释放路径加锁，因此只能传入本分配器分配的指针，
+			// 传入其他来源的指针是未定义行为。小块的 span 在析构前不归还，重复释放能够识别并返回 false；
+			// 大块释放时立即交还 std::free，不能检测重复释放
+			bool free_(block<byte>* block);
+			bool free_(void* ptr);
+
+			// 分配并构造一个 T
+			template<typename T, typename... Args>
+			T* new_(Args&&... args) {
+				static_assert(alignof(T) <= 16, "caching_allocator only guarantees 16 byte alignment");
+				auto raw = malloc_(sizeof(T));
+				try {
+					return new (raw.start) T(std::forward<Args>(args)...);
+				}
+				catch (...) {
+					free_(raw.start);
+					throw;
+				}
+			}
+
+			// 析构并释放一个 T
+			template<typename T>
+			bool delete_(T* ptr) {
+				if (!ptr || !owns(ptr)) {
+					return false;
+				}
+				ptr->~T();
+				return free_(static_cast<void*>(ptr));
+			}
+
+			// 将当前线程缓存的远程释放批次立即归还给所属线程
+			void flush_remote();
+
+			// 挂接分配统计，nullptr 表示不统计；应在并发使用前设置。小块按所属级别的可用字节数计
+			void set_stats(allocation_stats* stats) {
+				stats_ = stats;
+			}
+
+			allocation_stats* get_stats() const {
+				return stats_;
+			}
+
+			// 已向系统申请的小块内存总字节数
+			u64 get_span_bytes() const;
+
+			// 尺寸分级：请求大小（含块头）到级别，以及级别对应的块大小
+			static u32 size_to_class(u64 size);
+			static u64 class_to_size(u32 size_class);
+
+		private:
+			friend struct local::thread_cache_registrations;
+
+			struct depot_shard {
+				threaded_data_container::spin_lock lock;
+				std::vector<std::pair<local::cached_free_block*, u32>> batches;	// 每批的链表头与数量
+			};
+
+			// 读取块头判断块是否存活，ptr 必须为空或来自本分配器（见 free_）
+			bool owns(void* ptr) const;
+			local::thread_cache* get_cache();
+			void release_cache(local::thread_cache* cache);
+			void refill(local::thread_cache* cache, u32 size_class);
+			void drain_remote(local::thread_cache* cache);
+			void push_remote(local::thread_cache* cache, local::thread_cache* owner, local::cached_free_block* block);
+			void flush_remote_slot(local::thread_cache* cache, u32 slot);
+			void return_batch(local::thread_cache* cache, u32 size_class, u32 count);
+			static u32 batch_size(u32 size_class);
+
+			u64 id_;
+			std::atomic<local::thread_cache*> caches_{ nullptr };
+			depot_shard depot_[class_count];
+
+			std::mutex span_mutex_;
+			std::vector<byte*> spans_;
+			std::atomic<u64> span_bytes_{ 0 };
+			allocation_stats* stats_ = nullptr;
+		};
+
+		namespace local {
+			// 伙伴分配器空闲块的链表节点，位于空闲块数据区内
+			struct buddy_node {
+				buddy_node* prev;
+				buddy_node* next;
+			};
+		}
+
+		// 伙伴分配器：管理一块预留的连续区域，块大小为 min_block 的 2 的幂倍。
+		// 分配时逐级对半拆分，释放时与同级空闲伙伴逐级合并，均为 O(log n)；
+		// 每个块按自身大小对齐（不超过页大小）。区域在构造时一次映射，内存上限固定。
+		// 每 min_block 字节另需 1 字节的状态表。非线程安全。
+		class buddy_allocator {
+		public:
+			static constexpr u32 max_orders = 64;
+
+			// capacity: 区域大小，向上取整为 min_block 的 2 的幂倍；min_block: 最小块大小，向上取整为 2 的幂
+			buddy_allocator(u64 capacity, u64 min_block = 64);
+			~buddy_allocator();
+
+			buddy_allocator(const buddy_allocator&) = delete;
+			buddy_allocator& operator=(const buddy_allocator&) = delete;
+
+			// 分配至少 size 字节，没有足够大的空闲块时返回 start 为 nullptr 的块
+			block<byte> malloc_(u64 size);
+
+			// 释放通过 `malloc_` 分配的内存；不属于本分配器或重复释放时返回 false
+			bool free_(block<byte>* block);
+			bool free_(void* ptr);
+
+			// size 字节的请求实际占用的块大小
+			u64 block_size(u64 size) const {
+				return min_block_ << order_of(size);
+			}
+
+			u64 get_capacity() const {
+				return capacity_;
+			}
+
+			u64 get_free_bytes() const {
+				return free_bytes_;
+			}
+
+			// 当前最大的空闲块，决定了下一次能成功分配的最大请求
+			u64 get_largest_free_block() const;
+
+			// 外部碎片率：1 - 最大空闲块 / 空闲总量，没有空闲内存时为 0
+			f64 get_fragmentation() const;
+
+			// 挂接分配统计，nullptr 表示不统计；按实际块大小计
+			void set_stats(allocation_stats* stats) {
+				stats_ = stats;
+			}
+
+			allocation_stats* get_stats() const {
+				return stats_;
+			}
+
+		private:
+			static constexpr u8 interior = 0xFF;	// 不是块的起点
+			static constexpr u8 allocated = 0x80;	// 块已分配，低位为阶
+
+			u32 order_of(u64 size) const;
+			local::buddy_node* node_at(u64 index) const {
+				return reinterpret_cast<local::buddy_node*>(base_ + (index << min_shift_));
+			}
+			void push_free(u64 index, u32 order);
+			void remove_free(u64 index, u32 order);
+
+			byte* base_ = nullptr;
+			u64 capacity_ = 0;
+			u64 min_block_ = 0;
+			u32 min_shift_ = 0;
+			u32 max_order_ = 0;
+			u64 free_bytes_ = 0;
+			u64 nonempty_ = 0;								// 第 k 位表示第 k 阶空闲链表非空
+			local::buddy_node* free_lists_[max_orders] = {};
+			std::vector<u8> states_;						// 每个最小块一项：interior、阶或 allocated | 阶
+			allocation_stats* stats_ = nullptr;
+		};
+
+		// 以下为 std::pmr::memory_resource 适配器，使标准容器可以使用本模块的分配器。
+		// 适配器只引用被适配的分配器，不管理其生命周期；被适配分配器无法满足的请求转交 upstream。
+		// 两个适配器仅当是同一对象时相等。
+
+		// arena 适配器：deallocate 不做任何事，内存随 arena 的 rewind / reset / release 整体回收
+		class arena_resource : public std::pmr::memory_resource {
+		public:
+			explicit arena_resource(arena_allocator& arena) : arena_(arena) {}
+
+			arena_allocator& get_allocator() const {
+				return arena_;
+			}
+
+		private:
+			void* do_allocate(size_t bytes, size_t alignment) override {
+				return arena_.malloc_(bytes, alignment).start;
+			}
+			void do_deallocate(void*, size_t, size_t) override {}
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+				return this == &other;
+			}
+
+			arena_allocator& arena_;
+		};
+
+		// 对象池适配器：不超过一个槽位且对齐满足的请求从池中分配，其余转交 upstream。
+		// 与 pool_allocator 一样非线程安全。
+		template<typename T, bool cache_line_aligned = false>
+		class pool_resource : public std::pmr::memory_resource {
+		public:
+			using pool_t = pool_allocator<T, cache_line_aligned>;
+
+			explicit pool_resource(pool_t& pool, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+				: pool_(pool), upstream_(upstream) {}
+
+			pool_t& get_allocator() const {
+				return pool_;
+			}
+
+			std::pmr::memory_resource* upstream_resource() const {
+				return upstream_;
+			}
+
+		private:
+			static bool fits(size_t bytes, size_t alignment) {
+				return bytes <= pool_t::slot_size && alignment <= pool_t::slot_alignment;
+			}
+
+			void* do_allocate(size_t bytes, size_t alignment) override {
+				if (fits(bytes, alignment)) {
+					return pool_.allocate();
+				}
+				return upstream_->allocate(bytes, alignment);
+			}
+			void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+				if (fits(bytes, alignment)) {
+					pool_.deallocate(static_cast<T*>(ptr));
+				}
+				else {
+					upstream_->deallocate(ptr, bytes, alignment);
+				}
+			}
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+				return this == &other;
+			}
+
+			pool_t& pool_;
+			std::pmr::memory_resource* upstream_;
+		};
+
+		// 线程缓存适配器：对齐不超过 16 字节的请求由 caching_allocator 处理，其余转交 upstream。线程安全。
+		class caching_resource : public std::pmr::memory_resource {
+		public:
+			explicit caching_resource(caching_allocator& cache, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+				: cache_(cache), upstream_(upstream) {}
+
+			caching_allocator& get_allocator() const {
+				return cache_;
+			}
+
+			std::pmr::memory_resource* upstream_resource() const {
+				return upstream_;
+			}
+
+		private:
+			void* do_allocate(size_t bytes, size_t alignment) override;
+			void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+				return this == &other;
+			}
+
+			caching_allocator& cache_;
+			std::pmr::memory_resource* upstream_;
+		};
+
+		// system_allocator 适配器：任意对齐的请求都由 system_allocator 处理，大块按 options 映射页面。
+		// 以 upstream 构造时保持原有行为：对齐超过 max_align_t 的请求转交 upstream。
+		// 与 system_allocator 一样非线程安全。
+		class system_resource : public std::pmr::memory_resource {
+		public:
+			explicit system_resource(system_allocator& system, page_options options = {})
+				: system_(system), options_(options) {}
+
+			system_resource(system_allocator& system, std::pmr::memory_resource* upstream)
+				: system_(system), upstream_(upstream) {}
+
+			system_allocator& get_allocator() const {
+				return system_;
+			}
+
+			// 未指定 upstream 时为 nullptr
+			std::pmr::memory_resource* upstream_resource() const {
+				return upstream_;
+			}
+
+		private:
+			void* do_allocate(size_t bytes, size_t alignment) override;
+			void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+				return this == &other;
+			}
+
+			system_allocator& system_;
+			page_options options_;
+			std::pmr::memory_resource* upstream_ = nullptr;
+		};
+
+		// 伙伴分配器适配器：对齐不超过页大小的请求按 max(bytes, alignment) 分配以获得自然对齐，
+		// 区域耗尽时抛出 std::bad_alloc，不回退到其他资源。非线程安全。
+		class buddy_resource : public std::pmr::memory_resource {
+		public:
+			explicit buddy_resource(buddy_allocator& buddy) : buddy_(buddy) {}
+
+			buddy_allocator& get_allocator() const {
+				return buddy_;
+			}
+
+		private:
+			void* do_allocate(size_t bytes, size_t alignment) override;
+			void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+				return this == &other;
+			}
+
+			buddy_allocator& buddy_;
 		};
 	}
 	
@@ -0,0 +1,74 @@
+#include "parallel.hpp"
+
+namespace tools {
+	namespace parallel {
+		size_t default_grain(size_t size, thread_pool::executor& executor_) {
+			size_t chunks = static_cast<size_t>(executor_.size()) * 4;
+			return std::max<size_t>(1, (size + chunks - 1) / chunks);
+		}
+
+		size_t chunk_count(size_t size, size_t grain) {
+			grain = std::max<size_t>(grain, 1);
+			return (size + grain - 1) / grain;
+		}
+
+		range chunk_range(size_t size, size_t grain, size_t index) {
+			grain = std::max<size_t>(grain, 1);
+			size_t begin = index * grain;
+			return { begin, std::min(begin + grain, size) };
+		}
+	}
+
+	namespace test {
+#ifdef tools_debug
+		u64 parallel_test() {
+			using namespace tools::parallel;
+
+			u64 error = 0;
+			thread_pool::executor executor_two(thread_pool::config{ 2, false });
+			thread_pool::executor executor_four(thread_pool::config{ 4, false });
+
+			// 相同粒度下归约结果与线程数无关
+			std::vector<f64> values(100000);
+			for (size_t i = 0; i < values.size(); ++i) {
+				values[i] = 1.0 / static_cast<f64>(i + 1);
+			}
+			auto sum = [&](thread_pool::executor& executor_) {
+				return parallel_reduce(0, values.size(), 0.0,
+					[&](size_t i) { return values[i]; },
+					[](f64 a, f64 b) { return a + b; }, 1000, executor_);
+				};
+			if (sum(executor_two) != sum(executor_four)) {
+				error |= 结果错误;
+			}
+
+			// 并行变换
+			std::vector<f64> doubled(values.size());
+			parallel_transform(values.begin(), values.end(), doubled.begin(), [](f64 v) { return v * 2; }, 0, executor_four);
+			for (size_t i = 0; i < values.size(); ++i) {
+				if (doubled[i] != values[i] * 2) {
+					error |= 结果错误;
+					break;
+				}
+			}
+
+			// 并行排序与 std::sort 结果一致
+			std::vector<u64> data(200003);
+			u64 state = 88172645463325252ull;
+			for (auto& v : data) {
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+				v = state % 100000;
+			}
+			auto expected = data;
+			std::sort(expected.begin(), expected.end());
+			parallel_sort(data.begin(), data.end(), std::less<>(), 4096, executor_four);
+			if (data != expected) {
+				error |= 结果错误;
+			}
+			return error;
+		}
+#endif
+	}
+}
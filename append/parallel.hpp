@@ -0,0 +1,197 @@
+#pragma once
+#include "../tools.hpp"
+#include "./thread_pool.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+
+namespace tools {
+	namespace parallel {
+		// 左闭右开的分块区间
+		struct range {
+			size_t begin;
+			size_t end;
+		};
+
+		// 自动分块粒度：每个工作线程约分到 4 块，因此随 executor 的线程数变化
+		size_t default_grain(size_t size, thread_pool::executor& executor_);
+
+		// 按粒度分块后的块数，grain 为 0 时视为 1
+		size_t chunk_count(size_t size, size_t grain);
+
+		// 第 index 块的区间
+		range chunk_range(size_t size, size_t grain, size_t index);
+
+		namespace local {
+			// 在线程池上执行 count 个分块任务，调用线程执行第 0 块并等待其余块完成。
+			// 所有块结束后才重新抛出第一个异常。
+			template <typename F>
+			void run_chunks(size_t count, F& f, thread_pool::executor& executor_) {
+				if (count == 0) {
+					return;
+				}
+				if (count == 1) {
+					f(size_t(0));
+					return;
+				}
+
+				std::vector<thread_pool::future<void>> futures;
+				futures.reserve(count - 1);
+				for (size_t i = 1; i < count; ++i) {
+					futures.push_back(executor_.submit([&f, i]() { f(i); }));
+				}
+
+				std::exception_ptr exception;
+				try {
+					f(size_t(0));
+				}
+				catch (...) {
+					exception = std::current_exception();
+				}
+				for (auto& future : futures) {
+					try {
+						future.get();
+					}
+					catch (...) {
+						if (!exception) {
+							exception = std::current_exception();
+						}
+					}
+				}
+				if (exception) {
+					std::rethrow_exception(exception);
+				}
+			}
+		}
+
+		// 按块并行执行  f(chunk_begin, chunk_end)，grain 为 0 时自动选择
+		template <typename F>
+		void parallel_for_chunks(size_t begin, size_t end, F&& f, size_t grain = 0,
+			thread_pool::executor& executor_ = thread_pool::default_executor()) {
+			if (end <= begin) {
+				return;
+			}
+			size_t size = end - begin;
+			if (grain == 0) {
+				grain = default_grain(size, executor_);
+			}
+			auto chunk = [&](size_t index) {
+				auto r = chunk_range(size, grain, index);
+				f(begin + r.begin, begin + r.end);
+				};
+			local::run_chunks(chunk_count(size, grain), chunk, executor_);
+		}
+
+		// 并行执行 f(i)，i 属于 [begin, end)
+		template <typename F>
+		void parallel_for(size_t begin, size_t end, F&& f, size_t grain = 0,
+			thread_pool::executor& executor_ = thread_pool::default_executor()) {
+			parallel_for_chunks(begin, end, [&f](size_t chunk_begin, size_t chunk_end) {
+				for (size_t i = chunk_begin; i < chunk_end; ++i) {
+					f(i);
+				}
+				}, grain, executor_);
+		}
+
+		// 并行归约：每块从 identity 开始按下标顺序折叠 map(i)，再按块顺序折叠各块结果。
+		// 块的划分只取决于 grain，因此给定 grain 时结果与调度顺序无关（浮点求和可复现）。
+		// grain 为 0 时由 default_grain 按线程数选择，线程数不同的机器上浮点结果可能不同，需要复现时须显式传入 grain
+		template <typename T, typename Map, typename Reduce>
+		T parallel_reduce(size_t begin, size_t end, T identity, Map&& map, Reduce&& reduce, size_t grain = 0,
+			thread_pool::executor& executor_ = thread_pool::default_executor()) {
+			if (end <= begin) {
+				return identity;
+			}
+			size_t size = end - begin;
+			if (grain == 0) {
+				grain = default_grain(size, executor_);
+			}
+
+			size_t count = chunk_count(size, grain);
+			std::vector<T> partial(count, identity);
+			auto chunk = [&](size_t index) {
+				auto r = chunk_range(size, grain, index);
+				T value = identity;
+				for (size_t i = begin + r.begin; i < begin + r.end; ++i) {
+					value = reduce(std::move(value), map(i));
+				}
+				partial[index] = std::move(value);
+				};
+			local::run_chunks(count, chunk, executor_);
+
+			T result = identity;
+			for (auto& value : partial) {
+				result = reduce(std::move(result), std::move(value));
+			}
+			return result;
+		}
+
+		// 并行变换：out[i] = f(first[i])，要求随机访问迭代器
+		template <typename InputIt, typename OutputIt, typename F>
+		OutputIt parallel_transform(InputIt first, InputIt last, OutputIt out, F&& f, size_t grain = 0,
+			thread_pool::executor& executor_ = thread_pool::default_executor()) {
+			size_t size = static_cast<size_t>(std::distance(first, last));
+			parallel_for_chunks(0, size, [&](size_t chunk_begin, size_t chunk_end) {
+				std::transform(first + chunk_begin, first + chunk_end, out + chunk_begin, f);
+				}, grain, executor_);
+			return out + size;
+		}
+
+		// 并行排序：各块并行 std::sort，再逐轮并行两两归并（不保证稳定）
+		template <typename RandomIt, typename Compare = std::less<>>
+		void parallel_sort(RandomIt first, RandomIt last, Compare comp = Compare(), size_t grain = 0,
+			thread_pool::executor& executor_ = thread_pool::default_executor()) {
+			using value_t = typename std::iterator_traits<RandomIt>::value_type;
+
+			size_t size = static_cast<size_t>(std::distance(first, last));
+			if (grain == 0) {
+				grain = std::max<size_t>(default_grain(size, executor_), 1024);
+			}
+			if (size <= grain) {
+				std::sort(first, last, comp);
+				return;
+			}
+
+			parallel_for_chunks(0, size, [&](size_t chunk_begin, size_t chunk_end) {
+				std::sort(first + chunk_begin, first + chunk_end, comp);
+				}, grain, executor_);
+
+			// 在原数组与缓冲区之间交替归并
+			std::vector<value_t> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+			bool in_buffer = true;
+			for (size_t width = grain; width < size; width *= 2) {
+				size_t pairs = (size + 2 * width - 1) / (2 * width);
+				auto merge_pair = [&](size_t index) {
+					size_t left = index * 2 * width;
+					size_t middle = std::min(left + width, size);
+					size_t right = std::min(left + 2 * width, size);
+					if (in_buffer) {
+						std::merge(std::make_move_iterator(buffer.begin() + left), std::make_move_iterator(buffer.begin() + middle),
+							std::make_move_iterator(buffer.begin() + middle), std::make_move_iterator(buffer.begin() + right),
+							first + left, comp);
+					}
+					else {
+						std::merge(std::make_move_iterator(first + left), std::make_move_iterator(first + middle),
+							std::make_move_iterator(first + middle), std::make_move_iterator(first + right),
+							buffer.begin() + left, comp);
+					}
+					};
+				local::run_chunks(pairs, merge_pair, executor_);
+				in_buffer = !in_buffer;
+			}
+
+			if (in_buffer) {
+				parallel_for_chunks(0, size, [&](size_t chunk_begin, size_t chunk_end) {
+					std::move(buffer.begin() + chunk_begin, buffer.begin() + chunk_end, first + chunk_begin);
+					}, grain, executor_);
+			}
+		}
+	}
+
+	namespace test {
+#ifdef tools_debug
+		u64 parallel_test();
+#endif
+	}
+}
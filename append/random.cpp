@@ -1,7 +1,964 @@
 #include "random.hpp"
+#include "time.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <mutex>
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#include <sys/wait.h>
+#include <cerrno>
+#endif
+#if defined(__linux__) || defined(__unix__) || defined(__ANDROID__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || (defined(__APPLE__) && defined(__MACH__))
+#include <pthread.h>
+#define tools_random_has_fork 1
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define tools_random_x86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define tools_random_avx2_target
+#else
+#define tools_random_avx2_target __attribute__((target("avx2")))
+#endif
+#endif
 
 namespace tools {
 	namespace random {
+		namespace {
+			// fork 计数，子进程中由 pthread_atfork 回调递增
+			std::atomic<u64> fork_generation{ 0 };
+
+			void register_fork_handler() {
+#ifdef tools_random_has_fork
+				static std::once_flag once;
+				std::call_once(once, []() {
+					pthread_atfork(nullptr, nullptr, []() { fork_generation.fetch_add(1, std::memory_order_relaxed); });
+					});
+#endif
+			}
+
+			// 不会被编译器优化掉的清零
+			void secure_zero(void* ptr, size_t size) {
+#if defined(__GNUC__) || defined(__clang__)
+				// memset 之后用内存屏障告诉编译器结果会被读取，既不被消除也保留 memset 的速度
+				std::memset(ptr, 0, size);
+				__asm__ __volatile__("" : : "r"(ptr) : "memory");
+#else
+				volatile byte* p = static_cast<volatile byte*>(ptr);
+				while (size--) {
+					*p++ = 0;
+				}
+#endif
+			}
+
+			inline u32 rotl32(u32 value, int shift) {
+				return (value << shift) | (value >> (32 - shift));
+			}
+
+			inline u32 load_le32(const byte* p) {
+				return u32(p[0]) | (u32(p[1]) << 8) | (u32(p[2]) << 16) | (u32(p[3]) << 24);
+			}
+
+			inline void store_le32(byte* p, u32 value) {
+				p[0] = static_cast<byte>(value);
+				p[1] = static_cast<byte>(value >> 8);
+				p[2] = static_cast<byte>(value >> 16);
+				p[3] = static_cast<byte>(value >> 24);
+			}
+
+			// 以密钥与 64 位块计数构造 ChaCha20 输入状态，nonce 固定为 0（每次补充缓冲都会换密钥）
+			void chacha20_state(u32 state[16], const u32 key[8], u64 counter) {
+				state[0] = 0x61707865;	// "expand 32-byte k"
+				state[1] = 0x3320646e;
+				state[2] = 0x79622d32;
+				state[3] = 0x6b206574;
+				for (int i = 0; i < 8; ++i) {
+					state[4 + i] = key[i];
+				}
+				state[12] = static_cast<u32>(counter);
+				state[13] = static_cast<u32>(counter >> 32);
+				state[14] = 0;
+				state[15] = 0;
+			}
+
+#if defined(__linux__) || defined(__unix__) || defined(__ANDROID__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+			// 从 /dev/urandom 读满 buffer
+			void read_urandom(std::span<byte> buffer) {
+				int fd = open("/dev/urandom", O_RDONLY);
+				if (fd == -1) {
+					throw std::runtime_error("Failed to open /dev/urandom");
+				}
+				size_t done = 0;
+				while (done < buffer.size()) {
+					ssize_t result = read(fd, buffer.data() + done, buffer.size() - done);
+					if (result <= 0) {
+						close(fd);
+						throw std::runtime_error("Failed to read from /dev/urandom");
+					}
+					done += static_cast<size_t>(result);
+				}
+				close(fd);
+			}
+#endif
+		}
+
+		namespace local {
+			void chacha20_block(const u32 input[16], u32 output[16]) {
+				u32 x[16];
+				for (int i = 0; i < 16; ++i) {
+					x[i] = input[i];
+				}
+				// 以引用传入固定下标，便于编译器把 x 全部放进寄存器
+				auto quarter_round = [](u32& a, u32& b, u32& c, u32& d) {
+					a += b; d = rotl32(d ^ a, 16);
+					c += d; b = rotl32(b ^ c, 12);
+					a += b; d = rotl32(d ^ a, 8);
+					c += d; b = rotl32(b ^ c, 7);
+					};
+				for (int round = 0; round < 10; ++round) {
+					// 列轮
+					quarter_round(x[0], x[4], x[8], x[12]);
+					quarter_round(x[1], x[5], x[9], x[13]);
+					quarter_round(x[2], x[6], x[10], x[14]);
+					quarter_round(x[3], x[7], x[11], x[15]);
+					// 对角轮
+					quarter_round(x[0], x[5], x[10], x[15]);
+					quarter_round(x[1], x[6], x[11], x[12]);
+					quarter_round(x[2], x[7], x[8], x[13]);
+					quarter_round(x[3], x[4], x[9], x[14]);
+				}
+				for (int i = 0; i < 16; ++i) {
+					output[i] = x[i] + input[i];
+				}
+				secure_zero(x, sizeof(x));
+			}
+		}
+
+		namespace {
+#ifdef tools_random_x86
+			bool cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+				int info[4];
+				__cpuid(info, 0);
+				if (info[0] < 7) {
+					return false;
+				}
+				__cpuid(info, 1);
+				// OSXSAVE 与 AVX，且操作系统保存了 YMM 寄存器
+				if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+					return false;
+				}
+				__cpuidex(info, 7, 0);
+				return (info[1] & (1 << 5)) != 0;
+#else
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("avx2");
+#endif
+			}
+#endif
+
+			// 以同一密钥计算块号 counter 起的 blocks 个 ChaCha20 块，按块依次写入 out（每块 64 字节，小端）
+			using chacha20_kernel = void (*)(const u32 key[8], u64 counter, size_t blocks, byte* out);
+
+			void chacha20_kernel_scalar(const u32 key[8], u64 counter, size_t blocks, byte* out) {
+				u32 state[16];
+				u32 output[16];
+				for (size_t block = 0; block < blocks; ++block) {
+					chacha20_state(state, key, counter + block);
+					local::chacha20_block(state, output);
+					for (int i = 0; i < 16; ++i) {
+						store_le32(out + block * 64 + i * 4, output[i]);
+					}
+				}
+				secure_zero(state, sizeof(state));
+				secure_zero(output, sizeof(output));
+			}
+
+#ifdef tools_random_x86
+			// SSE2：每个寄存器保存 4 个块的同一个状态字，纵向并行计算 4 个块
+			template <int shift>
+			inline __m128i rotl32_sse2(__m128i value) {
+				return _mm_or_si128(_mm_slli_epi32(value, shift), _mm_srli_epi32(value, 32 - shift));
+			}
+
+			inline void quarter_round_sse2(__m128i& a, __m128i& b, __m128i& c, __m128i& d) {
+				a = _mm_add_epi32(a, b); d = rotl32_sse2<16>(_mm_xor_si128(d, a));
+				c = _mm_add_epi32(c, d); b = rotl32_sse2<12>(_mm_xor_si128(b, c));
+				a = _mm_add_epi32(a, b); d = rotl32_sse2<8>(_mm_xor_si128(d, a));
+				c = _mm_add_epi32(c, d); b = rotl32_sse2<7>(_mm_xor_si128(b, c));
+			}
+
+			// 把 4 个寄存器（同一组 4 个字在 4 个块中的值）转置后写入各块的对应位置
+			inline void store_transposed_sse2(__m128i w0, __m128i w1, __m128i w2, __m128i w3, byte* out, size_t word) {
+				__m128i t0 = _mm_unpacklo_epi32(w0, w1);
+				__m128i t1 = _mm_unpacklo_epi32(w2, w3);
+				__m128i t2 = _mm_unpackhi_epi32(w0, w1);
+				__m128i t3 = _mm_unpackhi_epi32(w2, w3);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + word * 4), _mm_unpacklo_epi64(t0, t1));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 64 + word * 4), _mm_unpackhi_epi64(t0, t1));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 128 + word * 4), _mm_unpacklo_epi64(t2, t3));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 192 + word * 4), _mm_unpackhi_epi64(t2, t3));
+			}
+
+			void chacha20_kernel_sse2(const u32 key[8], u64 counter, size_t blocks, byte* out) {
+				constexpr size_t width = 4;
+				size_t j = 0;
+				for (; j + width <= blocks; j += width) {
+					__m128i input[16];
+					u32 state[16];
+					chacha20_state(state, key, 0);
+					for (int i = 0; i < 16; ++i) {
+						input[i] = _mm_set1_epi32(static_cast<int>(state[i]));
+					}
+					alignas(16) u32 low_words[width], high_words[width];
+					for (size_t lane = 0; lane < width; ++lane) {
+						low_words[lane] = static_cast<u32>(counter + j + lane);
+						high_words[lane] = static_cast<u32>((counter + j + lane) >> 32);
+					}
+					input[12] = _mm_load_si128(reinterpret_cast<const __m128i*>(low_words));
+					input[13] = _mm_load_si128(reinterpret_cast<const __m128i*>(high_words));
+
+					__m128i x[16];
+					for (int i = 0; i < 16; ++i) {
+						x[i] = input[i];
+					}
+					for (int round = 0; round < 10; ++round) {
+						quarter_round_sse2(x[0], x[4], x[8], x[12]);
+						quarter_round_sse2(x[1], x[5], x[9], x[13]);
+						quarter_round_sse2(x[2], x[6], x[10], x[14]);
+						quarter_round_sse2(x[3], x[7], x[11], x[15]);
+						quarter_round_sse2(x[0], x[5], x[10], x[15]);
+						quarter_round_sse2(x[1], x[6], x[11], x[12]);
+						quarter_round_sse2(x[2], x[7], x[8], x[13]);
+						quarter_round_sse2(x[3], x[4], x[9], x[14]);
+					}
+					for (int i = 0; i < 16; ++i) {
+						x[i] = _mm_add_epi32(x[i], input[i]);
+					}
+					for (size_t word = 0; word < 16; word += 4) {
+						store_transposed_sse2(x[word], x[word + 1], x[word + 2], x[word + 3], out + j * 64, word);
+					}
+					secure_zero(state, sizeof(state));
+					secure_zero(x, sizeof(x));
+					secure_zero(input, sizeof(input));
+				}
+				chacha20_kernel_scalar(key, counter + j, blocks - j, out + j * 64);
+			}
+
+			// AVX2：8 个块并行，每个 256 位寄存器的低半边为块 0..3，高半边为块 4..7
+			template <int shift>
+			tools_random_avx2_target inline __m256i rotl32_avx2(__m256i value) {
+				return _mm256_or_si256(_mm256_slli_epi32(value, shift), _mm256_srli_epi32(value, 32 - shift));
+			}
+
+			tools_random_avx2_target inline void quarter_round_avx2(__m256i& a, __m256i& b, __m256i& c, __m256i& d) {
+				a = _mm256_add_epi32(a, b); d = rotl32_avx2<16>(_mm256_xor_si256(d, a));
+				c = _mm256_add_epi32(c, d); b = rotl32_avx2<12>(_mm256_xor_si256(b, c));
+				a = _mm256_add_epi32(a, b); d = rotl32_avx2<8>(_mm256_xor_si256(d, a));
+				c = _mm256_add_epi32(c, d); b = rotl32_avx2<7>(_mm256_xor_si256(b, c));
+			}
+
+			tools_random_avx2_target void chacha20_kernel_avx2(const u32 key[8], u64 counter, size_t blocks, byte* out) {
+				constexpr size_t width = 8;
+				size_t j = 0;
+				for (; j + width <= blocks; j += width) {
+					__m256i input[16];
+					u32 state[16];
+					chacha20_state(state, key, 0);
+					for (int i = 0; i < 16; ++i) {
+						input[i] = _mm256_set1_epi32(static_cast<int>(state[i]));
+					}
+					alignas(32) u32 low_words[width], high_words[width];
+					for (size_t lane = 0; lane < width; ++lane) {
+						low_words[lane] = static_cast<u32>(counter + j + lane);
+						high_words[lane] = static_cast<u32>((counter + j + lane) >> 32);
+					}
+					input[12] = _mm256_load_si256(reinterpret_cast<const __m256i*>(low_words));
+					input[13] = _mm256_load_si256(reinterpret_cast<const __m256i*>(high_words));
+
+					__m256i x[16];
+					for (int i = 0; i < 16; ++i) {
+						x[i] = input[i];
+					}
+					for (int round = 0; round < 10; ++round) {
+						quarter_round_avx2(x[0], x[4], x[8], x[12]);
+						quarter_round_avx2(x[1], x[5], x[9], x[13]);
+						quarter_round_avx2(x[2], x[6], x[10], x[14]);
+						quarter_round_avx2(x[3], x[7], x[11], x[15]);
+						quarter_round_avx2(x[0], x[5], x[10], x[15]);
+						quarter_round_avx2(x[1], x[6], x[11], x[12]);
+						quarter_round_avx2(x[2], x[7], x[8], x[13]);
+						quarter_round_avx2(x[3], x[4], x[9], x[14]);
+					}
+					for (int i = 0; i < 16; ++i) {
+						x[i] = _mm256_add_epi32(x[i], input[i]);
+					}
+					for (size_t word = 0; word < 16; word += 4) {
+						store_transposed_sse2(_mm256_castsi256_si128(x[word]), _mm256_castsi256_si128(x[word + 1]),
+							_mm256_castsi256_si128(x[word + 2]), _mm256_castsi256_si128(x[word + 3]), out + j * 64, word);
+						store_transposed_sse2(_mm256_extracti128_si256(x[word], 1), _mm256_extracti128_si256(x[word + 1], 1),
+							_mm256_extracti128_si256(x[word + 2], 1), _mm256_extracti128_si256(x[word + 3], 1), out + (j + 4) * 64, word);
+					}
+					secure_zero(state, sizeof(state));
+					secure_zero(x, sizeof(x));
+					secure_zero(input, sizeof(input));
+				}
+				chacha20_kernel_scalar(key, counter + j, blocks - j, out + j * 64);
+			}
+#endif
+
+			// 运行时选择最快的可用实现
+			chacha20_kernel active_chacha20_kernel() {
+#ifdef tools_random_x86
+				static const chacha20_kernel kernel = cpu_has_avx2() ? chacha20_kernel_avx2 : chacha20_kernel_sse2;
+				return kernel;
+#else
+				return chacha20_kernel_scalar;
+#endif
+			}
+		}
+
+		void __get_entropy(std::span<byte> buffer) {
+			if (buffer.empty()) {
+				return;
+			}
+#if defined(_WIN32) || defined(_WIN64)
+			HCRYPTPROV hProvider = 0;
+			if (!CryptAcquireContext(&hProvider, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT)) {
+				throw std::runtime_error("CryptAcquireContext failed");
+			}
+			if (!CryptGenRandom(hProvider, static_cast<DWORD>(buffer.size()), reinterpret_cast<BYTE*>(buffer.data()))) {
+				CryptReleaseContext(hProvider, 0);
+				throw std::runtime_error("CryptGenRandom failed");
+			}
+			CryptReleaseContext(hProvider, 0);
+#elif defined(__APPLE__) && defined(__MACH__)
+			if (SecRandomCopyBytes(kSecRandomDefault, buffer.size(), reinterpret_cast<uint8_t*>(buffer.data())) != errSecSuccess) {
+				throw std::runtime_error("SecRandomCopyBytes failed");
+			}
+#elif defined(__linux__)
+			size_t done = 0;
+			while (done < buffer.size()) {
+				ssize_t result = getrandom(buffer.data() + done, buffer.size() - done, 0);
+				if (result < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					if (errno == ENOSYS) {
+						// 内核早于 3.17
+						read_urandom(buffer.subspan(done));
+						return;
+					}
+					throw std::runtime_error("getrandom failed");
+				}
+				done += static_cast<size_t>(result);
+			}
+#elif defined(__unix__) || defined(__ANDROID__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+			read_urandom(buffer);
+#else
+			for (size_t i = 0; i < buffer.size(); i += sizeof(u64)) {
+				u64 value = __fallback_random();
+				std::memcpy(buffer.data() + i, &value, std::min(sizeof(u64), buffer.size() - i));
+			}
+#endif
+		}
+
+		chacha20_csprng::chacha20_csprng() {
+			register_fork_handler();
+			reseed();
+		}
+
+		chacha20_csprng::~chacha20_csprng() {
+			secure_zero(key_, sizeof(key_));
+			secure_zero(buffer_, sizeof(buffer_));
+		}
+
+		chacha20_csprng::result_type chacha20_csprng::operator()() {
+			u64 value;
+			fill(std::span<byte>(reinterpret_cast<byte*>(&value), sizeof(value)));
+			return value;
+		}
+
+		void chacha20_csprng::fill(std::span<byte> out) {
+			// fork 后子进程继承了父进程的密钥与缓冲，必须先重新播种
+			if (fork_generation_ != fork_generation.load(std::memory_order_relaxed)) {
+				reseed();
+			}
+			size_t done = 0;
+			while (done < out.size()) {
+				if (position_ == buffer_bytes) {
+					refill();
+				}
+				size_t take = static_cast<size_t>(std::min<u64>(out.size() - done, buffer_bytes - position_));
+				std::memcpy(out.data() + done, buffer_ + position_, take);
+				secure_zero(buffer_ + position_, take);
+				position_ += take;
+				done += take;
+			}
+			generated_ += out.size();
+		}
+
+		void chacha20_csprng::reseed() {
+			byte seed[32];
+			__get_entropy(seed);
+			for (int i = 0; i < 8; ++i) {
+				key_[i] = load_le32(seed + i * 4);
+			}
+			secure_zero(seed, sizeof(seed));
+			secure_zero(buffer_, sizeof(buffer_));
+			position_ = buffer_bytes;
+			generated_ = 0;
+			fork_generation_ = fork_generation.load(std::memory_order_relaxed);
+			seeded_at_ = std::chrono::steady_clock::now();
+		}
+
+		void chacha20_csprng::check_reseed() {
+			if (generated_ >= reseed_bytes || std::chrono::steady_clock::now() - seeded_at_ >= reseed_interval) {
+				reseed();
+			}
+		}
+
+		void chacha20_csprng::refill() {
+			check_reseed();
+			active_chacha20_kernel()(key_, 0, buffer_blocks, buffer_);
+			rekey();
+		}
+
+		void chacha20_csprng::rekey() {
+			// 前 32 字节作为下一轮密钥，不对外输出
+			for (int i = 0; i < 8; ++i) {
+				key_[i] = load_le32(buffer_ + i * 4);
+			}
+			secure_zero(buffer_, 32);
+			position_ = 32;
+		}
+
+		chacha20_csprng& chacha20_csprng::local() {
+			thread_local chacha20_csprng instance;
+			return instance;
+		}
+
+		void secure_fill(std::span<byte> out) {
+			chacha20_csprng::local().fill(out);
+		}
+
+		namespace {
+			using bulk_state = u64[4][bulk_random::lanes];
+			using bulk_kernel = void (*)(bulk_state& state, byte* out, size_t steps);
+
+			// 标量实现：逐路推进，每步输出 lanes 个值
+			void bulk_kernel_scalar(bulk_state& state, byte* out, size_t steps) {
+				for (size_t step = 0; step < steps; ++step) {
+					u64 values[bulk_random::lanes];
+					for (size_t lane = 0; lane < bulk_random::lanes; ++lane) {
+						const u64 s1 = state[1][lane];
+						values[lane] = std::rotl(s1 * 5, 7) * 9;
+						const u64 t = s1 << 17;
+						state[2][lane] ^= state[0][lane];
+						state[3][lane] ^= s1;
+						state[1][lane] ^= state[2][lane];
+						state[0][lane] ^= state[3][lane];
+						state[2][lane] ^= t;
+						state[3][lane] = std::rotl(state[3][lane], 45);
+					}
+					std::memcpy(out + step * sizeof(values), values, sizeof(values));
+				}
+			}
+
+#ifdef tools_random_x86
+			// SSE2 实现：每个寄存器 2 路，x * 5 与 x * 9 用移位加代替 64 位乘法
+			void bulk_kernel_sse2(bulk_state& state, byte* out, size_t steps) {
+				constexpr size_t vectors = bulk_random::lanes / 2;
+				__m128i s[4][vectors];
+				for (size_t word = 0; word < 4; ++word) {
+					for (size_t v = 0; v < vectors; ++v) {
+						s[word][v] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[word][v * 2]));
+					}
+				}
+				for (size_t step = 0; step < steps; ++step) {
+					for (size_t v = 0; v < vectors; ++v) {
+						__m128i x = _mm_add_epi64(s[1][v], _mm_slli_epi64(s[1][v], 2));
+						x = _mm_or_si128(_mm_slli_epi64(x, 7), _mm_srli_epi64(x, 57));
+						x = _mm_add_epi64(x, _mm_slli_epi64(x, 3));
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(out + (step * bulk_random::lanes + v * 2) * sizeof(u64)), x);
+
+						const __m128i t = _mm_slli_epi64(s[1][v], 17);
+						s[2][v] = _mm_xor_si128(s[2][v], s[0][v]);
+						s[3][v] = _mm_xor_si128(s[3][v], s[1][v]);
+						s[1][v] = _mm_xor_si128(s[1][v], s[2][v]);
+						s[0][v] = _mm_xor_si128(s[0][v], s[3][v]);
+						s[2][v] = _mm_xor_si128(s[2][v], t);
+						s[3][v] = _mm_or_si128(_mm_slli_epi64(s[3][v], 45), _mm_srli_epi64(s[3][v], 19));
+					}
+				}
+				for (size_t word = 0; word < 4; ++word) {
+					for (size_t v = 0; v < vectors; ++v) {
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(&state[word][v * 2]), s[word][v]);
+					}
+				}
+			}
+
+			// AVX2 实现：每个寄存器 4 路，两组寄存器交替以隐藏延迟
+			tools_random_avx2_target void bulk_kernel_avx2(bulk_state& state, byte* out, size_t steps) {
+				constexpr size_t vectors = bulk_random::lanes / 4;
+				__m256i s[4][vectors];
+				for (size_t word = 0; word < 4; ++word) {
+					for (size_t v = 0; v < vectors; ++v) {
+						s[word][v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&state[word][v * 4]));
+					}
+				}
+				for (size_t step = 0; step < steps; ++step) {
+					for (size_t v = 0; v < vectors; ++v) {
+						__m256i x = _mm256_add_epi64(s[1][v], _mm256_slli_epi64(s[1][v], 2));
+						x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+						x = _mm256_add_epi64(x, _mm256_slli_epi64(x, 3));
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + (step * bulk_random::lanes + v * 4) * sizeof(u64)), x);
+
+						const __m256i t = _mm256_slli_epi64(s[1][v], 17);
+						s[2][v] = _mm256_xor_si256(s[2][v], s[0][v]);
+						s[3][v] = _mm256_xor_si256(s[3][v], s[1][v]);
+						s[1][v] = _mm256_xor_si256(s[1][v], s[2][v]);
+						s[0][v] = _mm256_xor_si256(s[0][v], s[3][v]);
+						s[2][v] = _mm256_xor_si256(s[2][v], t);
+						s[3][v] = _mm256_or_si256(_mm256_slli_epi64(s[3][v], 45), _mm256_srli_epi64(s[3][v], 19));
+					}
+				}
+				for (size_t word = 0; word < 4; ++word) {
+					for (size_t v = 0; v < vectors; ++v) {
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(&state[word][v * 4]), s[word][v]);
+					}
+				}
+			}
+#endif
+
+			// 运行时选择最快的可用实现
+			bulk_kernel select_bulk_kernel() {
+#ifdef tools_random_x86
+				if (cpu_has_avx2()) {
+					return bulk_kernel_avx2;
+				}
+				return bulk_kernel_sse2;
+#else
+				return bulk_kernel_scalar;
+#endif
+			}
+
+			bulk_kernel active_bulk_kernel() {
+				static const bulk_kernel kernel = select_bulk_kernel();
+				return kernel;
+			}
+		}
+
+		void xoshiro256ss::seed(u64 seed_value) {
+			u64 mixer = seed_value;
+			for (auto& word : state_) {
+				word = local::splitmix64(mixer);
+			}
+		}
+
+		void xoshiro256ss::jump_with(const u64 (&polynomial)[4]) {
+			u64 result[4] = { 0, 0, 0, 0 };
+			for (u64 word : polynomial) {
+				for (int bit = 0; bit < 64; ++bit) {
+					if (word & (u64(1) << bit)) {
+						for (int i = 0; i < 4; ++i) {
+							result[i] ^= state_[i];
+						}
+					}
+					(*this)();
+				}
+			}
+			for (int i = 0; i < 4; ++i) {
+				state_[i] = result[i];
+			}
+		}
+
+		void xoshiro256ss::jump() {
+			static constexpr u64 polynomial[4] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+			jump_with(polynomial);
+		}
+
+		void xoshiro256ss::long_jump() {
+			static constexpr u64 polynomial[4] = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 };
+			jump_with(polynomial);
+		}
+
+		void pcg64::seed(u64 seed_value, u64 stream) {
+			increment_ = { stream >> 63, (stream << 1) | 1 };
+			state_ = local::add({ 0, seed_value }, increment_);
+			state_ = local::add(local::mul(state_, multiplier), increment_);
+		}
+
+		void pcg64::advance(local::u128 delta) {
+			// 按二进制位累乘 LCG 变换 x -> m * x + c（Brown, "Random Number Generation with Arbitrary Strides"）
+			local::u128 accumulated_multiplier{ 0, 1 };
+			local::u128 accumulated_increment{ 0, 0 };
+			local::u128 current_multiplier = multiplier;
+			local::u128 current_increment = increment_;
+			while (delta.high != 0 || delta.low != 0) {
+				if (delta.low & 1) {
+					accumulated_multiplier = local::mul(accumulated_multiplier, current_multiplier);
+					accumulated_increment = local::add(local::mul(accumulated_increment, current_multiplier), current_increment);
+				}
+				current_increment = local::mul(local::add(current_multiplier, { 0, 1 }), current_increment);
+				current_multiplier = local::mul(current_multiplier, current_multiplier);
+				delta = { delta.high >> 1, (delta.low >> 1) | (delta.high << 63) };
+			}
+			state_ = local::add(local::mul(accumulated_multiplier, state_), accumulated_increment);
+		}
+
+		bulk_random::bulk_random(u64 seed_value) : bulk_random(xoshiro256ss(seed_value)) {}
+
+		bulk_random::bulk_random(xoshiro256ss base) {
+			for (size_t lane = 0; lane < lanes; ++lane) {
+				for (size_t word = 0; word < 4; ++word) {
+					state_[word][lane] = base.state_[word];
+				}
+				base.jump();
+			}
+		}
+
+		void bulk_random::generate(byte* out, size_t bytes) {
+			constexpr size_t step_bytes = lanes * sizeof(u64);
+			size_t steps = bytes / step_bytes;
+			bulk_kernel kernel = active_bulk_kernel();
+			kernel(state_, out, steps);
+			size_t rest = bytes - steps * step_bytes;
+			if (rest > 0) {
+				byte tail[step_bytes];
+				kernel(state_, tail, 1);
+				std::memcpy(out + steps * step_bytes, tail, rest);
+			}
+		}
+
+		void bulk_random::fill(std::span<u64> out) {
+			generate(reinterpret_cast<byte*>(out.data()), out.size_bytes());
+		}
+
+		void bulk_random::fill(std::span<u32> out) {
+			generate(reinterpret_cast<byte*>(out.data()), out.size_bytes());
+		}
+
+		void bulk_random::fill(std::span<byte> out) {
+			generate(out.data(), out.size());
+		}
+
+		void bulk_random::fill_uniform(std::span<f64> out) {
+			// 先把随机位写进目标内存，再原地转换
+			generate(reinterpret_cast<byte*>(out.data()), out.size_bytes());
+			for (auto& value : out) {
+				u64 bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				value = static_cast<f64>(bits >> 11) * 0x1.0p-53;
+			}
+		}
+
+		void bulk_random::fill_uniform(std::span<f32> out) {
+			generate(reinterpret_cast<byte*>(out.data()), out.size_bytes());
+			for (auto& value : out) {
+				u32 bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				value = static_cast<f32>(bits >> 8) * 0x1.0p-24f;
+			}
+		}
+
+		namespace local {
+			void philox4x32_block(const u32 counter[4], const u32 key[2], u32 out[4]) {
+				u32 c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+				u32 k0 = key[0], k1 = key[1];
+				for (int round = 0; round < 10; ++round) {
+					const u64 product0 = u64(0xd2511f53) * c0;
+					const u64 product1 = u64(0xcd9e8d57) * c2;
+					const u32 next0 = static_cast<u32>(product1 >> 32) ^ c1 ^ k0;
+					const u32 next2 = static_cast<u32>(product0 >> 32) ^ c3 ^ k1;
+					c1 = static_cast<u32>(product1);
+					c3 = static_cast<u32>(product0);
+					c0 = next0;
+					c2 = next2;
+					k0 += 0x9e3779b9;
+					k1 += 0xbb67ae85;
+				}
+				out[0] = c0;
+				out[1] = c1;
+				out[2] = c2;
+				out[3] = c3;
+			}
+		}
+
+		namespace {
+			// 从块号 block 开始计算 blocks 个 Philox 块，每块 16 字节依次写入 out
+			using philox_kernel = void (*)(const u32 key[2], const u32 stream[2], u64 block, size_t blocks, byte* out);
+
+			void philox_kernel_scalar(const u32 key[2], const u32 stream[2], u64 block, size_t blocks, byte* out) {
+				for (size_t j = 0; j < blocks; ++j) {
+					u64 current = block + j;
+					const u32 counter[4] = { static_cast<u32>(current), static_cast<u32>(current >> 32), stream[0], stream[1] };
+					u32 words[4];
+					tools::random::local::philox4x32_block(counter, key, words);
+					const u64 values[2] = { u64(words[0]) | (u64(words[1]) << 32), u64(words[2]) | (u64(words[3]) << 32) };
+					std::memcpy(out + j * sizeof(values), values, sizeof(values));
+				}
+			}
+
+#ifdef tools_random_x86
+			// SSE2：4 个块的同一个计数字放在一个寄存器里；_mm_mul_epu32 只乘偶数路，奇数路右移后再乘一次
+			inline void philox_mulhilo_sse2(__m128i a, __m128i multiplier, __m128i& high, __m128i& low) {
+				const __m128i mask = _mm_set1_epi64x(0xffffffff);
+				__m128i even = _mm_mul_epu32(a, multiplier);
+				__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), multiplier);
+				low = _mm_or_si128(_mm_and_si128(even, mask), _mm_slli_epi64(odd, 32));
+				high = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(mask, odd));
+			}
+
+			void philox_kernel_sse2(const u32 key[2], const u32 stream[2], u64 block, size_t blocks, byte* out) {
+				constexpr size_t width = 4;
+				const __m128i multiplier0 = _mm_set1_epi32(static_cast<int>(0xd2511f53));
+				const __m128i multiplier1 = _mm_set1_epi32(static_cast<int>(0xcd9e8d57));
+				size_t j = 0;
+				for (; j + width <= blocks; j += width) {
+					alignas(16) u32 low_words[width], high_words[width];
+					for (size_t lane = 0; lane < width; ++lane) {
+						low_words[lane] = static_cast<u32>(block + j + lane);
+						high_words[lane] = static_cast<u32>((block + j + lane) >> 32);
+					}
+					__m128i c0 = _mm_load_si128(reinterpret_cast<const __m128i*>(low_words));
+					__m128i c1 = _mm_load_si128(reinterpret_cast<const __m128i*>(high_words));
+					__m128i c2 = _mm_set1_epi32(static_cast<int>(stream[0]));
+					__m128i c3 = _mm_set1_epi32(static_cast<int>(stream[1]));
+					u32 k0 = key[0], k1 = key[1];
+					for (int round = 0; round < 10; ++round) {
+						__m128i high0, low0, high1, low1;
+						philox_mulhilo_sse2(c0, multiplier0, high0, low0);
+						philox_mulhilo_sse2(c2, multiplier1, high1, low1);
+						c0 = _mm_xor_si128(_mm_xor_si128(high1, c1), _mm_set1_epi32(static_cast<int>(k0)));
+						c2 = _mm_xor_si128(_mm_xor_si128(high0, c3), _mm_set1_epi32(static_cast<int>(k1)));
+						c1 = low1;
+						c3 = low0;
+						k0 += 0x9e3779b9;
+						k1 += 0xbb67ae85;
+					}
+					// 4x4 转置，使每个块的 4 个字连续存放
+					__m128i t0 = _mm_unpacklo_epi32(c0, c1);
+					__m128i t1 = _mm_unpacklo_epi32(c2, c3);
+					__m128i t2 = _mm_unpackhi_epi32(c0, c1);
+					__m128i t3 = _mm_unpackhi_epi32(c2, c3);
+					byte* target = out + j * 16;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(target), _mm_unpacklo_epi64(t0, t1));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(target + 16), _mm_unpackhi_epi64(t0, t1));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(target + 32), _mm_unpacklo_epi64(t2, t3));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(target + 48), _mm_unpackhi_epi64(t2, t3));
+				}
+				philox_kernel_scalar(key, stream, block + j, blocks - j, out + j * 16);
+			}
+
+			tools_random_avx2_target inline void philox_mulhilo_avx2(__m256i a, __m256i multiplier, __m256i& high, __m256i& low) {
+				const __m256i mask = _mm256_set1_epi64x(0xffffffff);
+				__m256i even = _mm256_mul_epu32(a, multiplier);
+				__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), multiplier);
+				low = _mm256_or_si256(_mm256_and_si256(even, mask), _mm256_slli_epi64(odd, 32));
+				high = _mm256_or_si256(_mm256_srli_epi64(even, 32), _mm256_andnot_si256(mask, odd));
+			}
+
+			// AVX2：8 个块并行，转置在每个 128 位半边内进行，再按半边写出
+			tools_random_avx2_target void philox_kernel_avx2(const u32 key[2], const u32 stream[2], u64 block, size_t blocks, byte* out) {
+				constexpr size_t width = 8;
+				const __m256i multiplier0 = _mm256_set1_epi32(static_cast<int>(0xd2511f53));
+				const __m256i multiplier1 = _mm256_set1_epi32(static_cast<int>(0xcd9e8d57));
+				size_t j = 0;
+				for (; j + width <= blocks; j += width) {
+					alignas(32) u32 low_words[width], high_words[width];
+					for (size_t lane = 0; lane < width; ++lane) {
+						low_words[lane] = static_cast<u32>(block + j + lane);
+						high_words[lane] = static_cast<u32>((block + j + lane) >> 32);
+					}
+					__m256i c0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(low_words));
+					__m256i c1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(high_words));
+					__m256i c2 = _mm256_set1_epi32(static_cast<int>(stream[0]));
+					__m256i c3 = _mm256_set1_epi32(static_cast<int>(stream[1]));
+					u32 k0 = key[0], k1 = key[1];
+					for (int round = 0; round < 10; ++round) {
+						__m256i high0, low0, high1, low1;
+						philox_mulhilo_avx2(c0, multiplier0, high0, low0);
+						philox_mulhilo_avx2(c2, multiplier1, high1, low1);
+						c0 = _mm256_xor_si256(_mm256_xor_si256(high1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+						c2 = _mm256_xor_si256(_mm256_xor_si256(high0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+						c1 = low1;
+						c3 = low0;
+						k0 += 0x9e3779b9;
+						k1 += 0xbb67ae85;
+					}
+					// 低半边为块 0..3，高半边为块 4..7
+					__m256i t0 = _mm256_unpacklo_epi32(c0, c1);
+					__m256i t1 = _mm256_unpacklo_epi32(c2, c3);
+					__m256i t2 = _mm256_unpackhi_epi32(c0, c1);
+					__m256i t3 = _mm256_unpackhi_epi32(c2, c3);
+					__m256i b0 = _mm256_unpacklo_epi64(t0, t1);		// 块 0 | 块 4
+					__m256i b1 = _mm256_unpackhi_epi64(t0, t1);		// 块 1 | 块 5
+					__m256i b2 = _mm256_unpacklo_epi64(t2, t3);		// 块 2 | 块 6
+					__m256i b3 = _mm256_unpackhi_epi64(t2, t3);		// 块 3 | 块 7
+					byte* target = out + j * 16;
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(target), _mm256_permute2x128_si256(b0, b1, 0x20));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + 32), _mm256_permute2x128_si256(b2, b3, 0x20));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + 64), _mm256_permute2x128_si256(b0, b1, 0x31));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + 96), _mm256_permute2x128_si256(b2, b3, 0x31));
+				}
+				philox_kernel_scalar(key, stream, block + j, blocks - j, out + j * 16);
+			}
+#endif
+
+			philox_kernel active_philox_kernel() {
+#ifdef tools_random_x86
+				static const philox_kernel kernel = cpu_has_avx2() ? philox_kernel_avx2 : philox_kernel_sse2;
+				return kernel;
+#else
+				return philox_kernel_scalar;
+#endif
+			}
+		}
+
+		philox4x32::philox4x32(u64 key, u64 stream)
+			: key_{ static_cast<u32>(key), static_cast<u32>(key >> 32) },
+			stream_{ static_cast<u32>(stream), static_cast<u32>(stream >> 32) } {
+		}
+
+		void philox4x32::load_block(u64 block) {
+			const u32 counter[4] = { static_cast<u32>(block), static_cast<u32>(block >> 32), stream_[0], stream_[1] };
+			u32 words[4];
+			local::philox4x32_block(counter, key_, words);
+			buffer_[0] = u64(words[0]) | (u64(words[1]) << 32);
+			buffer_[1] = u64(words[2]) | (u64(words[3]) << 32);
+		}
+
+		u64 philox4x32::at(u64 index) const {
+			const u64 block = index >> 1;
+			const u32 counter[4] = { static_cast<u32>(block), static_cast<u32>(block >> 32), stream_[0], stream_[1] };
+			u32 words[4];
+			local::philox4x32_block(counter, key_, words);
+			return (index & 1) == 0 ? u64(words[0]) | (u64(words[1]) << 32) : u64(words[2]) | (u64(words[3]) << 32);
+		}
+
+		void philox4x32::generate(u64 first, std::span<u64> out) const {
+			if (out.empty()) {
+				return;
+			}
+			size_t done = 0;
+			if (first & 1) {
+				out[0] = at(first);
+				done = 1;
+			}
+			// 中间整块直接写入输出，末尾不足一块的单独计算
+			size_t blocks = (out.size() - done) / 2;
+			active_philox_kernel()(key_, stream_, (first + done) >> 1, blocks, reinterpret_cast<byte*>(out.data() + done));
+			done += blocks * 2;
+			if (done < out.size()) {
+				out[done] = at(first + done);
+			}
+		}
+
+		void philox4x32::seek(u64 index) {
+			position_ = index;
+			if (index & 1) {
+				load_block(index >> 1);
+			}
+		}
+
+		namespace local {
+			namespace {
+				// ln2 拆成高低两部分，k * ln2_high 对 |k| < 2^11 精确（fdlibm）
+				constexpr f64 ln2_high = 6.93147180369123816490e-01;
+				constexpr f64 ln2_low = 1.90821492927058770002e-10;
+				constexpr f64 inv_ln2 = 1.44269504088896338700e+00;
+			}
+
+			f64 deterministic_exp(f64 x) {
+				if (x != x) {
+					return x;
+				}
+				if (x > 709.782712893384) {
+					return std::numeric_limits<f64>::infinity();
+				}
+				if (x < -745.1332191019412) {
+					return 0.0;
+				}
+				// x = k * ln2 + r，|r| <= ln2 / 2，exp(r) 用 13 阶泰勒展开
+				f64 k = std::floor(x * inv_ln2 + 0.5);
+				f64 r = (x - k * ln2_high) - k * ln2_low;
+				f64 p = 1.0 / 6227020800.0;
+				for (f64 factorial : { 479001600.0, 39916800.0, 3628800.0, 362880.0, 40320.0, 5040.0, 720.0, 120.0, 24.0, 6.0, 2.0, 1.0, 1.0 }) {
+					p = p * r + 1.0 / factorial;
+				}
+				return std::ldexp(p, static_cast<int>(k));
+			}
+
+			f64 deterministic_log(f64 x) {
+				if (x != x || x == std::numeric_limits<f64>::infinity()) {
+					return x;
+				}
+				if (x < 0) {
+					return std::numeric_limits<f64>::quiet_NaN();
+				}
+				if (x == 0) {
+					return -std::numeric_limits<f64>::infinity();
+				}
+				// x = m * 2^e，m 属于 [sqrt(1/2), sqrt(2))；log(m) = 2 * atanh(s)，s = (m - 1) / (m + 1)
+				int exponent;
+				f64 m = std::frexp(x, &exponent);
+				if (m < 0.70710678118654752440) {
+					m *= 2;
+					--exponent;
+				}
+				f64 s = (m - 1.0) / (m + 1.0);
+				f64 z = s * s;
+				f64 series = 1.0 / 23.0;
+				for (f64 odd : { 21.0, 19.0, 17.0, 15.0, 13.0, 11.0, 9.0, 7.0, 5.0, 3.0, 1.0 }) {
+					series = series * z + 1.0 / odd;
+				}
+				f64 e = static_cast<f64>(exponent);
+				return e * ln2_high + (e * ln2_low + 2.0 * s * series);
+			}
+
+			namespace {
+				// pdf 为未归一化密度，inverse 为其反函数；v 为每层面积
+				template <typename Pdf, typename Inverse>
+				ziggurat_tables build_ziggurat(f64 r, f64 v, Pdf pdf, Inverse inverse) {
+					ziggurat_tables tables;
+					tables.r = r;
+					tables.x[0] = v / pdf(r);
+					tables.x[1] = r;
+					for (int i = 1; i < 255; ++i) {
+						tables.x[i + 1] = inverse(v / tables.x[i] + pdf(tables.x[i]));
+					}
+					tables.x[256] = 0;
+					for (int i = 0; i < 257; ++i) {
+						tables.f[i] = pdf(tables.x[i]);
+					}
+					return tables;
+				}
+			}
+
+			const ziggurat_tables& normal_tables() {
+				// Marsaglia & Tsang 2000 的 256 层参数；v = r * pdf(r) + 尾部面积
+				static const ziggurat_tables tables = build_ziggurat(3.654152885361008796, 4.928673233974658e-3,
+					[](f64 x) { return deterministic_exp(-0.5 * x * x); },
+					[](f64 y) { return std::sqrt(-2.0 * deterministic_log(y)); });
+				return tables;
+			}
+
+			const ziggurat_tables& exponential_tables() {
+				constexpr f64 r = 7.697117470131050077;
+				static const ziggurat_tables tables = build_ziggurat(r, (r + 1.0) * deterministic_exp(-r),
+					[](f64 x) { return deterministic_exp(-x); },
+					[](f64 y) { return -deterministic_log(y); });
+				return tables;
+			}
+		}
 #if defined(_WIN32) || defined(_WIN64)
 		// Windows 平台随机数生成实现
 		u64 __get_random_windows() {
@@ -76,20 +1033,229 @@ namespace tools {
 		}
 
 
-		// 跨平台真随机数生成函数
+		// 跨平台密码学安全随机数：熵源只用于播种，之后取自线程内缓冲的 ChaCha20 密钥流
 		u64 safe_random() {
-			u64 random_value = 0;
+			return chacha20_csprng::local()();
+		}
 
-			// 根据平台调用对应的随机数生成实现
-#if defined(_WIN32) || defined(_WIN64)
-			return __get_random_windows();
-#elif defined(__linux__) || defined(__unix__) || defined(__ANDROID__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
-			return __get_random_linux();
-#elif defined(__APPLE__) && defined(__MACH__)
-			return __get_random_macos();
-#else
-			return __fallback_random(); // 如果不支持以上平台，使用回退方案
-#endif
+		char* uuid::to_chars(char* out) const {
+			static constexpr char digits[] = "0123456789abcdef";
+			for (int i = 0; i < 16; ++i) {
+				if (i == 4 || i == 6 || i == 8 || i == 10) {
+					*out++ = '-';
+				}
+				*out++ = digits[bytes[i] >> 4];
+				*out++ = digits[bytes[i] & 0x0f];
+			}
+			return out;
+		}
+
+		std::string uuid::to_string() const {
+			std::string text(text_size, '\0');
+			to_chars(text.data());
+			return text;
+		}
+
+		u64 uuid::timestamp_ms() const {
+			u64 timestamp = 0;
+			for (int i = 0; i < 6; ++i) {
+				timestamp = (timestamp << 8) | bytes[i];
+			}
+			return timestamp;
+		}
+
+		namespace {
+			constexpr int uuid_counter_bits = 22;
+			constexpr u64 uuid_counter_mask = (u64(1) << uuid_counter_bits) - 1;
+
+			// 最近一次发出的 UUIDv7 的 (ms << 22) | counter
+			std::atomic<u64> uuid_v7_state{ 0 };
+
+			void set_uuid_v4_bits(uuid& value) {
+				value.bytes[6] = static_cast<byte>((value.bytes[6] & 0x0f) | 0x40);
+				value.bytes[8] = static_cast<byte>((value.bytes[8] & 0x3f) | 0x80);
+			}
+
+			// state 的高 42 位为毫秒数（对 48 位时间戳足够到 2109 年之后），低 22 位为计数；随机部分已在 value 中
+			void set_uuid_v7_fields(uuid& value, u64 state) {
+				u64 timestamp = state >> uuid_counter_bits;
+				u64 counter = state & uuid_counter_mask;
+				for (int i = 5; i >= 0; --i) {
+					value.bytes[i] = static_cast<byte>(timestamp);
+					timestamp >>= 8;
+				}
+				value.bytes[6] = static_cast<byte>(0x70 | ((counter >> 18) & 0x0f));
+				value.bytes[7] = static_cast<byte>(counter >> 10);
+				value.bytes[8] = static_cast<byte>(0x80 | ((counter >> 4) & 0x3f));
+				value.bytes[9] = static_cast<byte>(((counter & 0x0f) << 4) | (value.bytes[9] & 0x0f));
+			}
+
+			// 预留 count 个连续状态，返回第一个
+			u64 reserve_uuid_v7(u64 count, chacha20_csprng& generator) {
+				u64 now = tools::time::unix_milliseconds();
+				u64 start_of_ms = (now << uuid_counter_bits) | (generator() & (uuid_counter_mask >> 1));
+				u64 previous = uuid_v7_state.load(std::memory_order_relaxed);
+				while (true) {
+					u64 first = (previous >> uuid_counter_bits) < now ? start_of_ms : previous + 1;
+					if (uuid_v7_state.compare_exchange_weak(previous, first + count - 1, std::memory_order_relaxed)) {
+						return first;
+					}
+				}
+			}
+		}
+
+		uuid uuid_v4() {
+			uuid value;
+			chacha20_csprng::local().fill(value.bytes);
+			set_uuid_v4_bits(value);
+			return value;
+		}
+
+		void uuid_v4(std::span<uuid> out) {
+			static_assert(sizeof(uuid) == 16);
+			chacha20_csprng::local().fill(std::span<byte>(reinterpret_cast<byte*>(out.data()), out.size_bytes()));
+			for (auto& value : out) {
+				set_uuid_v4_bits(value);
+			}
+		}
+
+		uuid uuid_v7() {
+			uuid value;
+			auto& generator = chacha20_csprng::local();
+			generator.fill(std::span<byte>(value.bytes + 8, 8));
+			set_uuid_v7_fields(value, reserve_uuid_v7(1, generator));
+			return value;
+		}
+
+		void uuid_v7(std::span<uuid> out) {
+			if (out.empty()) {
+				return;
+			}
+			auto& generator = chacha20_csprng::local();
+			generator.fill(std::span<byte>(reinterpret_cast<byte*>(out.data()), out.size_bytes()));
+			u64 state = reserve_uuid_v7(out.size(), generator);
+			for (auto& value : out) {
+				set_uuid_v7_fields(value, state++);
+			}
+		}
+
+		bool quality_report::passed() const {
+			// 自由度 255 的卡方分布均值 255、标准差 sqrt(510)
+			const f64 chi_squared_sigma = std::sqrt(510.0);
+			return samples >= 1024 && std::abs(chi_squared - 255.0) < 5 * chi_squared_sigma &&
+				max_bit_bias_z < 5 && std::abs(serial_correlation_z) < 5;
+		}
+
+		quality_report check_quality(std::span<const u64> samples) {
+			quality_report report;
+			report.samples = samples.size();
+			if (samples.size() < 2) {
+				return report;
+			}
+			u64 byte_counts[256] = {};
+			u64 bit_counts[64] = {};
+			f64 sum = 0, square_sum = 0, product_sum = 0;
+			f64 previous = 0;
+			for (size_t i = 0; i < samples.size(); ++i) {
+				u64 value = samples[i];
+				for (int b = 0; b < 8; ++b) {
+					++byte_counts[(value >> (b * 8)) & 0xff];
+				}
+				for (int bit = 0; bit < 64; ++bit) {
+					bit_counts[bit] += (value >> bit) & 1;
+				}
+				f64 real = static_cast<f64>(value >> 11) * 0x1.0p-53;
+				sum += real;
+				square_sum += real * real;
+				if (i > 0) {
+					product_sum += previous * real;
+				}
+				previous = real;
+			}
+
+			const f64 n = static_cast<f64>(samples.size());
+			const f64 expected_bytes = n * 8 / 256;
+			for (u64 count : byte_counts) {
+				f64 difference = static_cast<f64>(count) - expected_bytes;
+				report.chi_squared += difference * difference / expected_bytes;
+			}
+			for (u64 count : bit_counts) {
+				f64 z = std::abs(static_cast<f64>(count) - n / 2) / std::sqrt(n / 4);
+				report.max_bit_bias_z = std::max(report.max_bit_bias_z, z);
+			}
+			// 滞后 1 的自相关系数（Knuth 3.3.2 的近似形式）
+			const f64 mean = sum / n;
+			const f64 variance = square_sum / n - mean * mean;
+			const f64 covariance = product_sum / (n - 1) - mean * mean;
+			f64 correlation = variance > 0 ? covariance / variance : 1.0;
+			report.serial_correlation_z = correlation * std::sqrt(n);
+			return report;
+		}
+
+		alias_table::alias_table(std::span<const f64> weights) {
+			const size_t size = weights.size();
+			if (size == 0) {
+				throw std::invalid_argument("alias_table: weights must not be empty");
+			}
+			f64 total = 0;
+			for (f64 weight : weights) {
+				if (!(weight >= 0) || weight == std::numeric_limits<f64>::infinity()) {
+					throw std::invalid_argument("alias_table: weights must be finite and non-negative");
+				}
+				total += weight;
+			}
+			if (!(total > 0) || total == std::numeric_limits<f64>::infinity()) {
+				throw std::invalid_argument("alias_table: total weight must be positive and finite");
+			}
+
+			// 缩放后平均值为 1；小于 1 的下标由一个大于 1 的下标补足
+			std::vector<f64> scaled(size);
+			std::vector<size_t> small, large;
+			for (size_t i = 0; i < size; ++i) {
+				scaled[i] = weights[i] * static_cast<f64>(size) / total;
+				(scaled[i] < 1.0 ? small : large).push_back(i);
+			}
+			constexpr f64 one = 0x1.0p53;
+			thresholds_.assign(size, u64(1) << 53);
+			aliases_.resize(size);
+			for (size_t i = 0; i < size; ++i) {
+				aliases_[i] = i;
+			}
+			while (!small.empty() && !large.empty()) {
+				size_t less = small.back();
+				small.pop_back();
+				size_t more = large.back();
+				large.pop_back();
+				thresholds_[less] = static_cast<u64>(scaled[less] * one);
+				aliases_[less] = more;
+				scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+				(scaled[more] < 1.0 ? small : large).push_back(more);
+			}
+			// 剩下的下标只差舍入误差，概率取 1
+		}
+
+		f64 alias_table::probability(size_t index) const {
+			f64 result = 0;
+			for (size_t i = 0; i < thresholds_.size(); ++i) {
+				f64 accept = static_cast<f64>(thresholds_[i]) * 0x1.0p-53;
+				if (i == index) {
+					result += accept;
+				}
+				if (aliases_[i] == index && i != index) {
+					result += 1.0 - accept;
+				}
+			}
+			return result / static_cast<f64>(thresholds_.size());
+		}
+
+		void alias_table::parallel_sample(std::span<size_t> out, u64 seed_value, size_t grain, thread_pool::executor& executor_) const {
+			if (grain == 0) {
+				grain = size_t(1) << 16;
+			}
+			parallel::parallel_for_chunks(0, out.size(), [&](size_t begin, size_t end) {
+				philox4x32 engine(seed_value, begin / grain);
+				sample(engine, out.subspan(begin, end - begin));
+				}, grain, executor_);
 		}
 	}
 
@@ -98,7 +1264,601 @@ namespace tools {
 #ifdef tools_debug
 	namespace test {
 		u64 random_test() {
-			return 0;
+			using namespace tools::random;
+			u64 error = 0;
+
+			// RFC 7539 2.3.2 块函数测试向量
+			u32 input[16] = {
+				0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+				0x03020100, 0x07060504, 0x0b0a0908, 0x0f0e0d0c,
+				0x13121110, 0x17161514, 0x1b1a1918, 0x1f1e1d1c,
+				0x00000001, 0x09000000, 0x4a000000, 0x00000000,
+			};
+			const u32 expected[16] = {
+				0xe4e7f110, 0x15593bd1, 0x1fdd0f50, 0xc47120a3,
+				0xc7f4d1c7, 0x0368c033, 0x9aaa2204, 0x4e6cd4c3,
+				0x466482d2, 0x09aa9f07, 0x05d7c214, 0xa2028bd9,
+				0xd19c12b5, 0xb94e16de, 0xe883d0cb, 0x4e3c50a2,
+			};
+			u32 output[16];
+			tools::random::local::chacha20_block(input, output);
+			for (int i = 0; i < 16; ++i) {
+				if (output[i] != expected[i]) {
+					error |= 结果错误;
+				}
+			}
+
+			// 各 ChaCha20 实现与标量实现一致（块计数跨越 2^32）
+			{
+				std::vector<chacha20_kernel> kernels;
+#ifdef tools_random_x86
+				kernels.push_back(chacha20_kernel_sse2);
+				if (cpu_has_avx2()) {
+					kernels.push_back(chacha20_kernel_avx2);
+				}
+#endif
+				const u32 key[8] = { 1, 2, 3, 4, 5, 6, 7, 0xdeadbeef };
+				std::vector<byte> reference(37 * 64), output(37 * 64);
+				chacha20_kernel_scalar(key, 0xfffffffe, 37, reference.data());
+				for (auto kernel : kernels) {
+					kernel(key, 0xfffffffe, 37, output.data());
+					if (output != reference) {
+						error |= 结果错误;
+					}
+				}
+			}
+
+			// 跨越多个缓冲区的填充不应出现重复块或全零块
+			std::vector<byte> bytes(chacha20_csprng::buffer_bytes * 5 + 7);
+			secure_fill(bytes);
+			for (size_t i = 64; i + 64 <= bytes.size(); i += 64) {
+				if (std::memcmp(bytes.data(), bytes.data() + i, 64) == 0) {
+					error |= 结果错误;
+				}
+			}
+			if (std::all_of(bytes.begin(), bytes.end(), [](byte b) { return b == 0; })) {
+				error |= 结果错误;
+			}
+
+			// 重新播种后输出继续有效
+			chacha20_csprng generator;
+			u64 first = generator();
+			generator.reseed();
+			if (first == generator() && first == generator()) {
+				error |= 结果错误;
+			}
+			if (safe_random() == safe_random() && safe_random() == safe_random()) {
+				error |= 结果错误;
+			}
+
+			// 引擎参考序列
+			static_assert(std::uniform_random_bit_generator<xoshiro256ss>);
+			static_assert(std::uniform_random_bit_generator<pcg64>);
+			static_assert(std::uniform_random_bit_generator<wyrand>);
+			xoshiro256ss xoshiro({ 1, 2, 3, 4 });
+			for (u64 value : { u64(11520), u64(0), u64(1509978240), u64(1215971899390074240) }) {
+				if (xoshiro() != value) {
+					error |= 结果错误;
+				}
+			}
+			pcg64 pcg(42, 54);
+			if (pcg() != 0x86b1da1d72062b68 || pcg() != 0x1304aa46c9853d39) {
+				error |= 结果错误;
+			}
+
+			// discard 与逐次调用一致
+			pcg64 pcg_skip(42, 54);
+			pcg_skip.discard(1002);
+			wyrand wy, wy_skip;
+			wy_skip.discard(1000);
+			for (int i = 0; i < 1000; ++i) {
+				pcg();
+				wy();
+			}
+			if (!(pcg == pcg_skip) || !(wy == wy_skip)) {
+				error |= 结果错误;
+			}
+
+			// jump 后的流与原流不重叠，且对同一状态结果确定
+			auto check_jump = [&error](auto engine) {
+				auto jumped = engine;
+				jumped.jump();
+				auto again = engine;
+				again.jump();
+				auto far = engine;
+				far.long_jump();
+				if (!(jumped == again) || jumped == engine || far == jumped) {
+					error |= 结果错误;
+				}
+				std::vector<u64> values;
+				for (int i = 0; i < 1000; ++i) {
+					values.push_back(engine());
+					values.push_back(jumped());
+					values.push_back(far());
+				}
+				std::sort(values.begin(), values.end());
+				if (std::adjacent_find(values.begin(), values.end()) != values.end()) {
+					error |= 结果错误;
+				}
+				};
+			check_jump(xoshiro256ss(7));
+			check_jump(pcg64(7));
+			check_jump(wyrand(7));
+
+			// 批量生成：第 k 路与 jump() k 次的 xoshiro256ss 流一致，各实现输出相同
+			{
+				const size_t count = bulk_random::lanes * 100 + 3;
+				std::vector<u64> expected_values(count);
+				xoshiro256ss base(11);
+				std::vector<xoshiro256ss> streams;
+				for (size_t lane = 0; lane < bulk_random::lanes; ++lane) {
+					streams.push_back(base);
+					base.jump();
+				}
+				for (size_t i = 0; i < count; ++i) {
+					expected_values[i] = streams[i % bulk_random::lanes]();
+				}
+				bulk_random bulk(11);
+				std::vector<u64> values(count);
+				bulk.fill(std::span<u64>(values));
+				if (values != expected_values) {
+					error |= 结果错误;
+				}
+
+				std::vector<bulk_kernel> kernels{ bulk_kernel_scalar };
+#ifdef tools_random_x86
+				kernels.push_back(bulk_kernel_sse2);
+				if (cpu_has_avx2()) {
+					kernels.push_back(bulk_kernel_avx2);
+				}
+#endif
+				// 从同一任意状态出发，各实现与标量实现逐值相同
+				bulk_state initial;
+				u64 mixer = 13;
+				for (auto& word : initial) {
+					for (auto& lane : word) {
+						lane = tools::random::local::splitmix64(mixer);
+					}
+				}
+				std::vector<u64> scalar_values(bulk_random::lanes * 100);
+				bulk_state scalar_state;
+				std::memcpy(scalar_state, initial, sizeof(initial));
+				bulk_kernel_scalar(scalar_state, reinterpret_cast<byte*>(scalar_values.data()), 100);
+				for (auto kernel : kernels) {
+					bulk_state state;
+					std::memcpy(state, initial, sizeof(initial));
+					std::vector<u64> kernel_values(scalar_values.size());
+					kernel(state, reinterpret_cast<byte*>(kernel_values.data()), 100);
+					if (kernel_values != scalar_values || std::memcmp(state, scalar_state, sizeof(state)) != 0) {
+						error |= 结果错误;
+					}
+				}
+
+				// u32 为 u64 输出的小端拆分；浮点数落在 [0, 1)
+				bulk_random bulk32(11);
+				std::vector<u32> halves(8);
+				bulk32.fill(std::span<u32>(halves));
+				if (halves[0] != static_cast<u32>(expected_values[0]) || halves[1] != static_cast<u32>(expected_values[0] >> 32)) {
+					error |= 结果错误;
+				}
+				std::vector<f64> doubles(10000);
+				std::vector<f32> floats(10000);
+				bulk_random uniform(5);
+				uniform.fill_uniform(std::span<f64>(doubles));
+				uniform.fill_uniform(std::span<f32>(floats));
+				f64 sum = 0;
+				for (size_t i = 0; i < doubles.size(); ++i) {
+					if (doubles[i] < 0 || doubles[i] >= 1 || floats[i] < 0 || floats[i] >= 1) {
+						error |= 结果错误;
+					}
+					sum += doubles[i] + floats[i];
+				}
+				if (std::abs(sum / (2 * doubles.size()) - 0.5) > 0.02) {
+					error |= 结果错误;
+				}
+
+				// 并行填充结果与线程数无关
+				tools::thread_pool::executor single(tools::thread_pool::config{ 1, false });
+				tools::thread_pool::executor several(tools::thread_pool::config{ 4, false });
+				std::vector<byte> bytes_single(100000), bytes_several(100000);
+				parallel_fill(std::span<byte>(bytes_single), 3, 4096, single);
+				parallel_fill(std::span<byte>(bytes_several), 3, 4096, several);
+				if (bytes_single != bytes_several) {
+					error |= 结果错误;
+				}
+				std::vector<f64> uniform_single(50000), uniform_several(50000);
+				parallel_fill_uniform(std::span<f64>(uniform_single), 3, 1000, single);
+				parallel_fill_uniform(std::span<f64>(uniform_several), 3, 1000, several);
+				if (uniform_single != uniform_several) {
+					error |= 结果错误;
+				}
+			}
+
+			// 分布
+			{
+				// 自实现 exp / log 与 libm 的相对误差
+				for (f64 x = -700; x < 700; x += 0.37) {
+					f64 expected_exp = std::exp(x);
+					if (std::abs(tools::random::local::deterministic_exp(x) - expected_exp) > 4e-16 * expected_exp) {
+						error |= 结果错误;
+					}
+				}
+				for (f64 x = 1e-300; x < 1e300; x *= 7.3) {
+					f64 expected_log = std::log(x);
+					if (std::abs(tools::random::local::deterministic_log(x) - expected_log) > 4e-16 * std::abs(expected_log) + 1e-300) {
+						error |= 结果错误;
+					}
+				}
+
+				// 有界整数落在范围内且各值频率接近
+				xoshiro256ss engine(21);
+				u64 counts[7] = {};
+				for (int i = 0; i < 70000; ++i) {
+					++counts[bounded(engine, 7)];
+				}
+				for (u64 count : counts) {
+					if (count < 9500 || count > 10500) {
+						error |= 结果错误;
+					}
+				}
+				for (int i = 0; i < 1000; ++i) {
+					i64 value = uniform_int(engine, -3, 3);
+					if (value < -3 || value > 3 || bounded(engine, 1) != 0) {
+						error |= 结果错误;
+					}
+				}
+				uniform_int(engine, std::numeric_limits<i64>::min(), std::numeric_limits<i64>::max());
+
+				// 正态与指数分布的矩
+				const size_t samples = 200000;
+				std::vector<f64> normals(samples), exponentials(samples);
+				fill_normal(engine, std::span<f64>(normals));
+				fill_exponential(engine, std::span<f64>(exponentials), 2.0);
+				f64 normal_sum = 0, normal_square = 0, exponential_sum = 0;
+				for (size_t i = 0; i < samples; ++i) {
+					normal_sum += normals[i];
+					normal_square += normals[i] * normals[i];
+					exponential_sum += exponentials[i];
+					if (exponentials[i] < 0) {
+						error |= 结果错误;
+					}
+				}
+				f64 normal_mean = normal_sum / samples;
+				if (std::abs(normal_mean) > 0.01 || std::abs(normal_square / samples - normal_mean * normal_mean - 1) > 0.02 ||
+					std::abs(exponential_sum / samples - 0.5) > 0.01) {
+					error |= 结果错误;
+				}
+
+				// 批量与逐个调用一致；固定种子的输出与平台无关，与记录值比较
+				xoshiro256ss batch_engine(99), single_engine(99);
+				std::vector<f64> batch(1000);
+				fill_normal(batch_engine, std::span<f64>(batch));
+				u64 checksum = 0;
+				for (f64 value : batch) {
+					if (value != normal(single_engine)) {
+						error |= 结果错误;
+					}
+					checksum = checksum * 31 + std::bit_cast<u64>(value);
+				}
+				if (checksum != 0x52564f5dbd1df21f) {
+					error |= 结果错误;
+				}
+			}
+
+			// Philox4x32-10：Random123 已知答案测试
+			{
+				struct known_answer {
+					u32 counter[4];
+					u32 key[2];
+					u32 expected[4];
+				};
+				const known_answer answers[] = {
+					{ { 0, 0, 0, 0 }, { 0, 0 }, { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+					{ { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff }, { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } },
+					{ { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 }, { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } },
+				};
+				for (const auto& answer : answers) {
+					u32 words[4];
+					tools::random::local::philox4x32_block(answer.counter, answer.key, words);
+					if (!std::equal(words, words + 4, answer.expected)) {
+						error |= 结果错误;
+					}
+				}
+
+				// 批量生成与 at() 一致，跨越 2^32 块边界且起点为奇数
+				philox4x32 philox(0x0123456789abcdef, 7);
+				const u64 first = (u64(1) << 33) - 21;
+				std::vector<u64> batch(203);
+				philox.generate(first, std::span<u64>(batch));
+				for (size_t i = 0; i < batch.size(); ++i) {
+					if (batch[i] != philox.at(first + i)) {
+						error |= 结果错误;
+					}
+				}
+
+				// 各实现与标量实现一致
+				std::vector<philox_kernel> kernels{ philox_kernel_scalar };
+#ifdef tools_random_x86
+				kernels.push_back(philox_kernel_sse2);
+				if (cpu_has_avx2()) {
+					kernels.push_back(philox_kernel_avx2);
+				}
+#endif
+				const u32 key[2] = { 3, 4 };
+				const u32 stream[2] = { 5, 6 };
+				std::vector<byte> reference(37 * 16), output(37 * 16);
+				philox_kernel_scalar(key, stream, 0xfffffff0, 37, reference.data());
+				for (auto kernel : kernels) {
+					kernel(key, stream, 0xfffffff0, 37, output.data());
+					if (output != reference) {
+						error |= 结果错误;
+					}
+				}
+
+				// 引擎接口：顺序输出、seek、discard，不同 stream 互不相同
+				philox4x32 sequential(42, 1), other_stream(42, 2);
+				for (u64 i = 0; i < 100; ++i) {
+					if (sequential() != sequential.at(i) || other_stream.at(i) == sequential.at(i)) {
+						error |= 结果错误;
+					}
+				}
+				sequential.seek(1001);
+				u64 sought = sequential();
+				sequential.discard(10);
+				if (sought != sequential.at(1001) || sequential() != sequential.at(1012) || sequential.position() != 1013) {
+					error |= 结果错误;
+				}
+				static_assert(std::uniform_random_bit_generator<philox4x32>);
+				normal(sequential);
+			}
+
+			// 洗牌与抽样
+			{
+				// 并行洗牌得到原序列的排列，且与线程数无关
+				std::vector<u32> values(100000);
+				for (size_t i = 0; i < values.size(); ++i) {
+					values[i] = static_cast<u32>(i);
+				}
+				tools::thread_pool::executor single(tools::thread_pool::config{ 1, false });
+				tools::thread_pool::executor several(tools::thread_pool::config{ 4, false });
+				auto shuffled_single = values, shuffled_several = values;
+				parallel_shuffle(shuffled_single.begin(), shuffled_single.end(), 17, 3000, single);
+				parallel_shuffle(shuffled_several.begin(), shuffled_several.end(), 17, 3000, several);
+				if (shuffled_single != shuffled_several || shuffled_single == values) {
+					error |= 结果错误;
+				}
+				std::sort(shuffled_several.begin(), shuffled_several.end());
+				if (shuffled_several != values) {
+					error |= 结果错误;
+				}
+				// 默认粒度同样与线程数无关
+				auto default_single = values, default_several = values;
+				parallel_shuffle(default_single.begin(), default_single.end(), 17, 0, single);
+				parallel_shuffle(default_several.begin(), default_several.end(), 17, 0, several);
+				if (default_single != default_several) {
+					error |= 结果错误;
+				}
+
+				// 均匀性：6 个元素、小粒度（强制多轮合并），每个元素出现在每个位置的频率约 1/6
+				u64 position_counts[6][6] = {};
+				const int rounds = 60000;
+				for (int round = 0; round < rounds; ++round) {
+					u32 small[6] = { 0, 1, 2, 3, 4, 5 };
+					parallel_shuffle(small, small + 6, static_cast<u64>(round), 2, single);
+					for (int position = 0; position < 6; ++position) {
+						++position_counts[small[position]][position];
+					}
+				}
+				for (auto& row : position_counts) {
+					for (u64 count : row) {
+						if (count < 9400 || count > 10600) {
+							error |= 结果错误;
+						}
+					}
+				}
+
+				// 蓄水池抽样：每个元素被选中的频率约 k / n，合并后以及被合并方重新抽样时同样
+				u64 hits[50] = {}, merged_hits[50] = {}, reused_hits[50] = {};
+				xoshiro256ss engine(31);
+				for (int round = 0; round < 20000; ++round) {
+					std::vector<u32> population(50);
+					for (u32 i = 0; i < 50; ++i) {
+						population[i] = i;
+					}
+					for (u32 value : reservoir_sample(population.begin(), population.end(), 5, engine)) {
+						++hits[value];
+					}
+					reservoir_sampler<u32, xoshiro256ss&> left(5, engine), right(5, engine);
+					for (u32 i = 0; i < 50; ++i) {
+						(i < 12 ? left : right).offer(i);
+					}
+					left.merge(right);
+					if (left.samples().size() != 5 || left.seen() != 50) {
+						error |= 结果错误;
+					}
+					for (u32 value : left.samples()) {
+						++merged_hits[value];
+					}
+					if (right.seen() != 0 || !right.samples().empty() || right.pending_skip() != 0) {
+						error |= 结果错误;
+					}
+					for (u32 i = 0; i < 50; ++i) {
+						right.offer(i);
+					}
+					for (u32 value : right.samples()) {
+						++reused_hits[value];
+					}
+				}
+				for (int i = 0; i < 50; ++i) {
+					if (hits[i] < 1800 || hits[i] > 2200 || merged_hits[i] < 1800 || merged_hits[i] > 2200
+						|| reused_hits[i] < 1800 || reused_hits[i] > 2200) {
+						error |= 结果错误;
+					}
+				}
+
+				// 别名表：概率与权重一致，抽样频率接近
+				const f64 weights[] = { 1, 0, 3, 6, 0.5, 9.5 };
+				alias_table table(weights);
+				for (size_t i = 0; i < 6; ++i) {
+					if (std::abs(table.probability(i) - weights[i] / 20.0) > 1e-12) {
+						error |= 结果错误;
+					}
+				}
+				std::vector<size_t> drawn(200000);
+				table.parallel_sample(drawn, 5, 10000, several);
+				u64 drawn_counts[6] = {};
+				for (size_t value : drawn) {
+					++drawn_counts[value];
+				}
+				for (size_t i = 0; i < 6; ++i) {
+					if (std::abs(static_cast<f64>(drawn_counts[i]) / drawn.size() - weights[i] / 20.0) > 0.005) {
+						error |= 结果错误;
+					}
+				}
+				try {
+					alias_table invalid(std::span<const f64>{});
+					error |= 结果错误;
+				}
+				catch (const std::invalid_argument&) {
+				}
+			}
+
+			// UUID
+			{
+				uuid fixed;
+				for (int i = 0; i < 16; ++i) {
+					fixed.bytes[i] = static_cast<byte>(i);
+				}
+				if (fixed.to_string() != "00010203-0405-0607-0809-0a0b0c0d0e0f") {
+					error |= 结果错误;
+				}
+
+				std::vector<uuid> v4(1000);
+				uuid_v4(v4);
+				v4.push_back(uuid_v4());
+				for (const auto& value : v4) {
+					if (value.version() != 4 || (value.bytes[8] & 0xc0) != 0x80) {
+						error |= 结果错误;
+					}
+				}
+				std::sort(v4.begin(), v4.end());
+				if (std::adjacent_find(v4.begin(), v4.end()) != v4.end()) {
+					error |= 结果错误;
+				}
+
+				// 多线程生成的 UUIDv7 各线程内严格递增，全体互不相同，时间戳接近当前时间
+				u64 before = tools::time::unix_milliseconds();
+				std::vector<std::vector<uuid>> per_thread(4);
+				std::vector<std::thread> threads;
+				for (auto& ids : per_thread) {
+					threads.emplace_back([&ids]() {
+						for (int i = 0; i < 20000; ++i) {
+							if (i % 100 == 0) {
+								std::vector<uuid> batch(50);
+								uuid_v7(batch);
+								ids.insert(ids.end(), batch.begin(), batch.end());
+							}
+							ids.push_back(uuid_v7());
+						}
+						});
+				}
+				for (auto& thread : threads) {
+					thread.join();
+				}
+				u64 after = tools::time::unix_milliseconds();
+				std::vector<uuid> all;
+				for (auto& ids : per_thread) {
+					for (size_t i = 0; i < ids.size(); ++i) {
+						if ((i > 0 && !(ids[i - 1] < ids[i])) || ids[i].version() != 7 || (ids[i].bytes[8] & 0xc0) != 0x80 ||
+							ids[i].timestamp_ms() < before || ids[i].timestamp_ms() > after + 1000) {
+							error |= 结果错误;
+						}
+					}
+					all.insert(all.end(), ids.begin(), ids.end());
+				}
+				std::sort(all.begin(), all.end());
+				if (std::adjacent_find(all.begin(), all.end()) != all.end()) {
+					error |= 结果错误;
+				}
+				char text[uuid::text_size];
+				if (all.front().to_chars(text) != text + uuid::text_size || text[14] != '7') {
+					error |= 结果错误;
+				}
+			}
+
+			// 各引擎与批量接口输出的统计冒烟检验；明显有缺陷的序列必须被识别出来
+			{
+				std::vector<u64> samples(1 << 16);
+				auto check_engine = [&](auto engine) {
+					for (auto& value : samples) {
+						value = engine();
+					}
+					if (!check_quality(samples).passed()) {
+						error |= 结果错误;
+					}
+					};
+				check_engine(xoshiro256ss(1));
+				check_engine(pcg64(1));
+				check_engine(wyrand(1));
+				check_engine(philox4x32(1));
+				check_engine(std::ref(chacha20_csprng::local()));
+				bulk_random bulk(1);
+				bulk.fill(std::span<u64>(samples));
+				if (!check_quality(samples).passed()) {
+					error |= 结果错误;
+				}
+				philox4x32(2).generate(0, samples);
+				if (!check_quality(samples).passed()) {
+					error |= 结果错误;
+				}
+
+				// 计数器、截断低位和重复值都应被拒绝
+				for (size_t i = 0; i < samples.size(); ++i) {
+					samples[i] = i * 0x9e3779b97f4a7c15;
+				}
+				if (check_quality(samples).passed()) {
+					error |= 结果错误;
+				}
+				xoshiro256ss source(3);
+				for (auto& value : samples) {
+					value = source() & ~u64(0xff);
+				}
+				if (check_quality(samples).passed()) {
+					error |= 结果错误;
+				}
+				for (size_t i = 0; i < samples.size(); i += 2) {
+					samples[i] = source();
+					samples[i + 1] = samples[i] ^ 1;
+				}
+				if (check_quality(samples).passed()) {
+					error |= 结果错误;
+				}
+			}
+
+#if defined(__linux__)
+			// fork 后子进程必须重新播种，不能与父进程输出相同的字节
+			int pipes[2];
+			if (pipe(pipes) == 0) {
+				chacha20_csprng::local()();
+				pid_t pid = fork();
+				if (pid == 0) {
+					u64 value = chacha20_csprng::local()();
+					ssize_t written = write(pipes[1], &value, sizeof(value));
+					_exit(written == sizeof(value) ? 0 : 1);
+				}
+				if (pid > 0) {
+					u64 parent = chacha20_csprng::local()();
+					u64 child = 0;
+					if (read(pipes[0], &child, sizeof(child)) != sizeof(child) || child == parent) {
+						error |= 结果错误;
+					}
+					waitpid(pid, nullptr, 0);
+				}
+				close(pipes[0]);
+				close(pipes[1]);
+			}
+#endif
+			return error;
 		}
 	}
 #endif
@@ -1,5 +1,6 @@
 #pragma once
 #include "../tools.hpp"
+#include "./parallel.hpp"
 
 
 #include <stdexcept>
@@ -8,6 +9,9 @@
 #include <random>
 #include <thread>
 #include <functional>
+#include <span>
+#include <limits>
+#include <bit>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
@@ -33,8 +37,892 @@ namespace tools {
 #endif
 		u64 __fallback_random();
 
-		// 跨平台真随机数生成函数
+		// 从操作系统熵源读取 buffer.size() 字节（Linux 为 getrandom），失败时抛出 std::runtime_error
+		void __get_entropy(std::span<byte> buffer);
+
+		// 跨平台密码学安全随机数，取自当前线程的 chacha20_csprng
 		u64 safe_random();
+
+		// 用密码学安全随机字节填充 out，取自当前线程的 chacha20_csprng
+		void secure_fill(std::span<byte> out);
+
+		namespace local {
+			// ChaCha20 块函数：对 16 字的输入状态做 20 轮运算，输出 64 字节密钥流
+			void chacha20_block(const u32 input[16], u32 output[16]);
+
+			// SplitMix64：把一个 64 位种子展开为多个互不相关的状态字
+			inline u64 splitmix64(u64& state) {
+				u64 z = (state += 0x9e3779b97f4a7c15);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+				return z ^ (z >> 31);
+			}
+
+			// 可移植的 128 位无符号整数，只实现 PCG 需要的运算
+			struct u128 {
+				u64 high;
+				u64 low;
+
+				bool operator==(const u128&) const = default;
+			};
+
+			// 64 x 64 -> 128 位乘法
+			inline u128 mul_wide(u64 a, u64 b) {
+#if defined(__SIZEOF_INT128__)
+				unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+				return { static_cast<u64>(product >> 64), static_cast<u64>(product) };
+#else
+				u64 a_low = a & 0xffffffff, a_high = a >> 32;
+				u64 b_low = b & 0xffffffff, b_high = b >> 32;
+				u64 low_low = a_low * b_low;
+				u64 high_low = a_high * b_low;
+				u64 low_high = a_low * b_high;
+				u64 high_high = a_high * b_high;
+				u64 middle = (low_low >> 32) + (high_low & 0xffffffff) + low_high;
+				return { high_high + (high_low >> 32) + (middle >> 32), (middle << 32) | (low_low & 0xffffffff) };
+#endif
+			}
+
+			inline u128 add(u128 a, u128 b) {
+				u64 low = a.low + b.low;
+				return { a.high + b.high + (low < a.low ? 1 : 0), low };
+			}
+
+			// 取低 128 位的乘法
+			inline u128 mul(u128 a, u128 b) {
+				u128 result = mul_wide(a.low, b.low);
+				result.high += a.high * b.low + a.low * b.high;
+				return result;
+			}
+		}
+
+		// 基于 ChaCha20 的密码学安全伪随机数生成器。
+		// 构造时从操作系统熵源取 256 位密钥，之后按块生成密钥流并在线程内缓冲，不再逐次系统调用。
+		// 每次补充缓冲都用新生成的前 32 字节替换密钥（快速密钥擦除），已输出的字节立即清零，
+		// 泄露当前状态也无法还原之前的输出。输出超过 reseed_bytes 字节、距上次播种超过 reseed_interval
+		// 或进程 fork 之后（子进程不会重复父进程的输出）都会从熵源重新播种。
+		// 满足 UniformRandomBitGenerator，非线程安全，每个线程使用 local() 返回的实例。
+		class chacha20_csprng {
+		public:
+			using result_type = u64;
+
+			static constexpr u64 buffer_blocks = 16;
+			static constexpr u64 buffer_bytes = buffer_blocks * 64;
+			static constexpr u64 reseed_bytes = u64(1) << 30;
+			static constexpr std::chrono::seconds reseed_interval{ 300 };
+
+			chacha20_csprng();
+			~chacha20_csprng();
+
+			chacha20_csprng(const chacha20_csprng&) = delete;
+			chacha20_csprng& operator=(const chacha20_csprng&) = delete;
+
+			static constexpr result_type min() {
+				return 0;
+			}
+			static constexpr result_type max() {
+				return std::numeric_limits<result_type>::max();
+			}
+
+			result_type operator()();
+
+			// 用随机字节填充 out
+			void fill(std::span<byte> out);
+
+			// 立即从操作系统熵源重新播种
+			void reseed();
+
+			// 当前线程的实例
+			static chacha20_csprng& local();
+
+		private:
+			void refill();
+			void rekey();
+			void check_reseed();
+
+			u32 key_[8];
+			byte buffer_[buffer_bytes];
+			u64 position_ = buffer_bytes;		// 缓冲区中下一个可用字节
+			u64 generated_ = 0;					// 自上次播种以来输出的字节数
+			u64 fork_generation_ = 0;
+			std::chrono::steady_clock::time_point seeded_at_;
+		};
+
+		// 以下为非密码学随机数引擎，均满足 UniformRandomBitGenerator，可直接用于 <random> 的分布。
+		// 同一种子经 jump() / long_jump() 得到互不重叠的子序列，适合给每个工作线程分配独立的流：
+		//   xoshiro256ss base(seed);
+		//   for (每个线程) { 线程私有 = base; base.jump(); }
+
+		class bulk_random;
+
+		// xoshiro256**：256 位状态，周期 2^256 - 1。
+		// jump() 相当于调用 2^128 次，long_jump() 相当于 2^192 次
+		class xoshiro256ss {
+		public:
+			using result_type = u64;
+
+			static constexpr u64 default_seed = 0x853c49e6748fea9b;
+
+			explicit xoshiro256ss(u64 seed_value = default_seed) {
+				seed(seed_value);
+			}
+
+			// 直接指定状态（不能全为 0），用于复现参考序列或恢复检查点
+			explicit xoshiro256ss(const u64 (&state)[4]) : state_{ state[0], state[1], state[2], state[3] } {}
+
+			// 用 SplitMix64 展开种子，保证状态不全为 0
+			void seed(u64 seed_value);
+
+			static constexpr result_type min() {
+				return 0;
+			}
+			static constexpr result_type max() {
+				return std::numeric_limits<result_type>::max();
+			}
+
+			result_type operator()() {
+				const u64 result = std::rotl(state_[1] * 5, 7) * 9;
+				const u64 t = state_[1] << 17;
+				state_[2] ^= state_[0];
+				state_[3] ^= state_[1];
+				state_[1] ^= state_[2];
+				state_[0] ^= state_[3];
+				state_[2] ^= t;
+				state_[3] = std::rotl(state_[3], 45);
+				return result;
+			}
+
+			void discard(u64 count) {
+				while (count--) {
+					(*this)();
+				}
+			}
+
+			void jump();
+			void long_jump();
+
+			bool operator==(const xoshiro256ss&) const = default;
+
+		private:
+			friend class bulk_random;
+
+			void jump_with(const u64 (&polynomial)[4]);
+
+			u64 state_[4];
+		};
+
+		// PCG64（XSL-RR 128/64）：128 位线性同余状态加输出置换，周期 2^128。
+		// 不同 stream 对应不同增量，互为独立序列；discard() 为 O(log n)。
+		// jump() 相当于调用 2^64 次，long_jump() 相当于 2^96 次
+		class pcg64 {
+		public:
+			using result_type = u64;
+
+			static constexpr u64 default_seed = 0xcafef00dd15ea5e5;
+			static constexpr u64 default_stream = 0x5851f42d4c957f2d;
+
+			explicit pcg64(u64 seed_value = default_seed, u64 stream = default_stream) {
+				seed(seed_value, stream);
+			}
+
+			// 与参考实现 pcg64(seed, stream) 的序列一致
+			void seed(u64 seed_value, u64 stream = default_stream);
+
+			static constexpr result_type min() {
+				return 0;
+			}
+			static constexpr result_type max() {
+				return std::numeric_limits<result_type>::max();
+			}
+
+			result_type operator()() {
+				state_ = local::add(local::mul(state_, multiplier), increment_);
+				return std::rotr(state_.high ^ state_.low, static_cast<int>(state_.high >> 58));
+			}
+
+			void discard(u64 count) {
+				advance({ 0, count });
+			}
+
+			void jump() {
+				advance({ 1, 0 });
+			}
+			void long_jump() {
+				advance({ u64(1) << 32, 0 });
+			}
+
+			bool operator==(const pcg64&) const = default;
+
+		private:
+			static constexpr local::u128 multiplier{ 0x2360ed051fc65da4, 0x4385df649fccf645 };
+
+			// 状态前进 delta 步
+			void advance(local::u128 delta);
+
+			local::u128 state_;
+			local::u128 increment_;
+		};
+
+		// wyrand：64 位计数器加一次 128 位乘法混合，是这里最快的引擎，周期 2^64。
+		// 状态只是计数器，discard() 为 O(1)；jump() 相当于调用 2^48 次，long_jump() 相当于 2^56 次
+		class wyrand {
+		public:
+			using result_type = u64;
+
+			static constexpr u64 default_seed = 0x9e3779b97f4a7c15;
+			static constexpr u64 increment = 0xa0761d6478bd642f;
+
+			explicit wyrand(u64 seed_value = default_seed) : state_(seed_value) {}
+
+			void seed(u64 seed_value) {
+				state_ = seed_value;
+			}
+
+			static constexpr result_type min() {
+				return 0;
+			}
+			static constexpr result_type max() {
+				return std::numeric_limits<result_type>::max();
+			}
+
+			result_type operator()() {
+				state_ += increment;
+				local::u128 product = local::mul_wide(state_, state_ ^ 0xe7037ed1a0b428db);
+				return product.high ^ product.low;
+			}
+
+			void discard(u64 count) {
+				state_ += count * increment;
+			}
+
+			void jump() {
+				discard(u64(1) << 48);
+			}
+			void long_jump() {
+				discard(u64(1) << 56);
+			}
+
+			bool operator==(const wyrand&) const = default;
+
+		private:
+			u64 state_;
+		};
+
+		// 多路交错的 xoshiro256** 批量生成器。
+		// lanes 路状态由同一个 xoshiro256ss 依次 jump() 得到，按 [状态字][路] 存放，每步同时推进所有路；
+		// 运行时选择 AVX2（每条指令 4 路）、SSE2（2 路）或标量实现，三者输出完全一致。
+		// 输出依次为第 0 步的第 0..lanes-1 路、第 1 步的各路……，第 k 路与对应的 xoshiro256ss 流逐值相同。
+		// 每次 fill 都按整步生成，不足一步的尾部多出的值被丢弃。
+		class bulk_random {
+		public:
+			static constexpr size_t lanes = 8;
+
+			explicit bulk_random(u64 seed_value = xoshiro256ss::default_seed);
+			explicit bulk_random(xoshiro256ss base);
+
+			void fill(std::span<u64> out);
+			void fill(std::span<u32> out);
+			void fill(std::span<byte> out);
+
+			// [0, 1) 内的均匀浮点数，f64 取 53 位、f32 取 24 位随机数
+			void fill_uniform(std::span<f64> out);
+			void fill_uniform(std::span<f32> out);
+
+		private:
+			// 生成 bytes 字节写入 out，out 不要求对齐
+			void generate(byte* out, size_t bytes);
+
+			alignas(32) u64 state_[4][lanes];
+		};
+
+		namespace local {
+			// 并行填充的默认分块：每块 1 MiB，与线程数无关以保证结果可复现
+			template <typename T>
+			constexpr size_t default_fill_grain = std::max<size_t>(1, (size_t(1) << 20) / sizeof(T));
+
+			// 第 i 块使用 seed 状态 long_jump() i 次后的 bulk_random 执行 fill_chunk(generator, chunk)
+			template <typename T, typename F>
+			void parallel_fill_with(std::span<T> out, u64 seed_value, size_t grain, thread_pool::executor& executor_, F&& fill_chunk) {
+				if (grain == 0) {
+					grain = default_fill_grain<T>;
+				}
+				size_t count = parallel::chunk_count(out.size(), grain);
+				std::vector<xoshiro256ss> bases;
+				bases.reserve(count);
+				xoshiro256ss base(seed_value);
+				for (size_t i = 0; i < count; ++i) {
+					bases.push_back(base);
+					base.long_jump();
+				}
+				auto chunk = [&](size_t index) {
+					auto r = parallel::chunk_range(out.size(), grain, index);
+					bulk_random generator(bases[index]);
+					fill_chunk(generator, out.subspan(r.begin, r.end - r.begin));
+					};
+				parallel::local::run_chunks(count, chunk, executor_);
+			}
+		}
+
+		// 并行填充大缓冲区，T 为 u64、u32 或 byte。
+		// 按 grain 个元素分块（0 表示 1 MiB），结果只取决于 seed 与 grain，与线程数和调度顺序无关
+		template <typename T>
+		void parallel_fill(std::span<T> out, u64 seed_value, size_t grain = 0,
+			thread_pool::executor& executor_ = thread_pool::default_executor()) {
+			local::parallel_fill_with(out, seed_value, grain, executor_, [](bulk_random& generator, std::span<T> chunk) {
+				generator.fill(chunk);
+				});
+		}
+
+		// 并行填充 [0, 1) 均匀浮点数，T 为 f64 或 f32，分块规则同 parallel_fill
+		template <typename T>
+		void parallel_fill_uniform(std::span<T> out, u64 seed_value, size_t grain = 0,
+			thread_pool::executor& executor_ = thread_pool::default_executor()) {
+			local::parallel_fill_with(out, seed_value, grain, executor_, [](bulk_random& generator, std::span<T> chunk) {
+				generator.fill_uniform(chunk);
+				});
+		}
+
+		// 以下分布函数只用整数运算、精确的位转换和 +-*/、sqrt（IEEE 754 保证正确舍入），
+		// 不调用平台 libm，因此同一种子在不同编译器与标准库下得到相同结果。
+		// 乘加被合并为 FMA 会改变舍入，因此要求关闭浮点收缩（GCC / Clang 的 -ffp-contract=off，tools 目标已设置）且不开 fast-math。
+		// Engine 须输出完整的 64 位，例如本文件中的各引擎与 std::mt19937_64。
+
+		namespace local {
+			template <typename Engine>
+			constexpr bool is_full_64_engine = std::uniform_random_bit_generator<Engine> &&
+				Engine::min() == 0 && Engine::max() == std::numeric_limits<u64>::max();
+
+			// 只用 +-*/ 实现的 exp / log，结果与平台无关，相对误差约 1e-16
+			f64 deterministic_exp(f64 x);
+			f64 deterministic_log(f64 x);
+
+			// 256 层 ziggurat 表：x[0] 为底层（含尾部）等面积宽度，x[1] 为尾部起点 r，x[256] = 0；f[i] = pdf(x[i])
+			struct ziggurat_tables {
+				f64 x[257];
+				f64 f[257];
+				f64 r;
+			};
+
+			// 首次调用时用 deterministic_exp / log 计算
+			const ziggurat_tables& normal_tables();
+			const ziggurat_tables& exponential_tables();
+
+			// 64 位随机数的高 53 位精确转换为 (0, 1]，用于取对数
+			inline f64 open_unit(u64 bits) {
+				return static_cast<f64>((bits >> 11) + 1) * 0x1.0p-53;
+			}
+
+			template <typename Engine>
+			f64 normal(Engine& engine, const ziggurat_tables& tables) {
+				while (true) {
+					u64 bits = engine();
+					size_t i = bits & 0xff;
+					// 低 8 位选层，高 53 位给出 [-1, 1) 的坐标，二者不重叠
+					f64 x = (static_cast<f64>(bits >> 11) * 0x1.0p-52 - 1.0) * tables.x[i];
+					if ((x < 0 ? -x : x) < tables.x[i + 1]) {
+						return x;
+					}
+					if (i == 0) {
+						// 尾部：Marsaglia 1964
+						f64 tail_x, tail_y;
+						do {
+							tail_x = -deterministic_log(open_unit(engine())) / tables.r;
+							tail_y = -deterministic_log(open_unit(engine()));
+						} while (tail_y + tail_y < tail_x * tail_x);
+						return x < 0 ? -(tables.r + tail_x) : tables.r + tail_x;
+					}
+					f64 u = static_cast<f64>(engine() >> 11) * 0x1.0p-53;
+					if (tables.f[i + 1] + (tables.f[i] - tables.f[i + 1]) * u < deterministic_exp(-0.5 * x * x)) {
+						return x;
+					}
+				}
+			}
+
+			template <typename Engine>
+			f64 exponential(Engine& engine, const ziggurat_tables& tables) {
+				while (true) {
+					u64 bits = engine();
+					size_t i = bits & 0xff;
+					f64 x = static_cast<f64>(bits >> 11) * 0x1.0p-53 * tables.x[i];
+					if (x < tables.x[i + 1]) {
+						return x;
+					}
+					if (i == 0) {
+						// 尾部无记忆性：r 加上一个新的指数变量
+						return tables.r - deterministic_log(open_unit(engine()));
+					}
+					f64 u = static_cast<f64>(engine() >> 11) * 0x1.0p-53;
+					if (tables.f[i + 1] + (tables.f[i] - tables.f[i + 1]) * u < deterministic_exp(-x)) {
+						return x;
+					}
+				}
+			}
+		}
+
+		// [0, range) 内的无偏整数（Lemire 近乎无除法方法，只有被拒绝时才做一次取模），range 为 0 时返回完整 64 位
+		template <typename Engine>
+		u64 bounded(Engine& engine, u64 range) {
+			static_assert(local::is_full_64_engine<Engine>, "Engine must produce full 64-bit values");
+			u64 value = engine();
+			if (range == 0) {
+				return value;
+			}
+			local::u128 product = local::mul_wide(value, range);
+			if (product.low < range) {
+				const u64 threshold = (0 - range) % range;
+				while (product.low < threshold) {
+					product = local::mul_wide(engine(), range);
+				}
+			}
+			return product.high;
+		}
+
+		// [min, max] 内的无偏整数
+		template <typename Engine>
+		i64 uniform_int(Engine& engine, i64 min, i64 max) {
+			u64 range = static_cast<u64>(max) - static_cast<u64>(min) + 1;
+			return static_cast<i64>(static_cast<u64>(min) + bounded(engine, range));
+		}
+
+		// [0, 1) 均匀浮点数，取高 53 / 24 位精确转换，不经过舍入
+		template <typename Engine>
+		f64 uniform_f64(Engine& engine) {
+			static_assert(local::is_full_64_engine<Engine>, "Engine must produce full 64-bit values");
+			return static_cast<f64>(engine() >> 11) * 0x1.0p-53;
+		}
+
+		template <typename Engine>
+		f32 uniform_f32(Engine& engine) {
+			static_assert(local::is_full_64_engine<Engine>, "Engine must produce full 64-bit values");
+			return static_cast<f32>(engine() >> 40) * 0x1.0p-24f;
+		}
+
+		// [low, high) 均匀浮点数
+		template <typename Engine>
+		f64 uniform_real(Engine& engine, f64 low, f64 high) {
+			return low + (high - low) * uniform_f64(engine);
+		}
+
+		// 正态分布（256 层 ziggurat）
+		template <typename Engine>
+		f64 normal(Engine& engine, f64 mean = 0.0, f64 stddev = 1.0) {
+			static_assert(local::is_full_64_engine<Engine>, "Engine must produce full 64-bit values");
+			return mean + stddev * local::normal(engine, local::normal_tables());
+		}
+
+		// 指数分布，rate 为 λ（256 层 ziggurat）
+		template <typename Engine>
+		f64 exponential(Engine& engine, f64 rate = 1.0) {
+			static_assert(local::is_full_64_engine<Engine>, "Engine must produce full 64-bit values");
+			return local::exponential(engine, local::exponential_tables()) / rate;
+		}
+
+		// 批量版本：与逐个调用对应的单值函数结果相同
+		template <typename Engine>
+		void fill_bounded(Engine& engine, std::span<u64> out, u64 range) {
+			for (auto& value : out) {
+				value = bounded(engine, range);
+			}
+		}
+
+		template <typename Engine>
+		void fill_uniform(Engine& engine, std::span<f64> out, f64 low = 0.0, f64 high = 1.0) {
+			for (auto& value : out) {
+				value = uniform_real(engine, low, high);
+			}
+		}
+
+		template <typename Engine>
+		void fill_normal(Engine& engine, std::span<f64> out, f64 mean = 0.0, f64 stddev = 1.0) {
+			static_assert(local::is_full_64_engine<Engine>, "Engine must produce full 64-bit values");
+			const auto& tables = local::normal_tables();
+			for (auto& value : out) {
+				value = mean + stddev * local::normal(engine, tables);
+			}
+		}
+
+		template <typename Engine>
+		void fill_exponential(Engine& engine, std::span<f64> out, f64 rate = 1.0) {
+			static_assert(local::is_full_64_engine<Engine>, "Engine must produce full 64-bit values");
+			const auto& tables = local::exponential_tables();
+			for (auto& value : out) {
+				value = local::exponential(engine, tables) / rate;
+			}
+		}
+
+		namespace local {
+			// Philox4x32-10 块函数（Salmon et al. 2011，与 Random123 的 philox4x32 相同）：128 位计数器加 64 位密钥映射为 128 位输出
+			void philox4x32_block(const u32 counter[4], const u32 key[2], u32 out[4]);
+		}
+
+		// 基于 Philox4x32-10 的计数器随机数：(key, stream, index) 直接映射为第 index 个 64 位输出，没有可变的共享状态。
+		// 任意线程都能以 O(1) 取得流中第 i 个值，结果与工作如何调度无关。
+		// 计数器由 64 位块号（index / 2）与 64 位 stream 组成，每块输出两个 64 位值。
+		// 同时也是满足 UniformRandomBitGenerator 的引擎，operator() 从 position() 开始顺序输出。
+		class philox4x32 {
+		public:
+			using result_type = u64;
+
+			explicit philox4x32(u64 key = 0, u64 stream = 0);
+
+			static constexpr result_type min() {
+				return 0;
+			}
+			static constexpr result_type max() {
+				return std::numeric_limits<result_type>::max();
+			}
+
+			// 第 index 个输出，不改变引擎位置
+			u64 at(u64 index) const;
+
+			// out[j] = at(first + j)，运行时选择 AVX2（8 块并行）、SSE2（4 块）或标量实现
+			void generate(u64 first, std::span<u64> out) const;
+
+			result_type operator()() {
+				u64 index = position_++;
+				if ((index & 1) == 0) {
+					load_block(index >> 1);
+					return buffer_[0];
+				}
+				return buffer_[1];
+			}
+
+			void discard(u64 count) {
+				seek(position_ + count);
+			}
+
+			// 把下一次 operator() 的输出定位到第 index 个
+			void seek(u64 index);
+
+			u64 position() const {
+				return position_;
+			}
+
+		private:
+			void load_block(u64 block);
+
+			u32 key_[2];
+			u32 stream_[2];
+			u64 position_ = 0;
+			u64 buffer_[2] = {};
+		};
+
+		// Fisher-Yates 洗牌，用 bounded 取下标，同一引擎状态在各标准库下结果相同（std::shuffle 不保证）
+		template <typename RandomIt, typename Engine>
+		void shuffle(RandomIt first, RandomIt last, Engine& engine) {
+			using std::swap;
+			size_t size = static_cast<size_t>(std::distance(first, last));
+			for (size_t i = size; i > 1; --i) {
+				size_t j = static_cast<size_t>(bounded(engine, i));
+				swap(first[i - 1], first[j]);
+			}
+		}
+
+		namespace local {
+			// MergeShuffle 的合并（Bacher et al. 2015）：[start, mid) 与 [mid, end) 各自已均匀打乱，
+			// 逐位抛硬币决定取左或右，一侧耗尽后把剩余元素逐个随机插入已合并部分
+			template <typename RandomIt, typename Engine>
+			void merge_shuffled(RandomIt first, size_t start, size_t mid, size_t end, Engine& engine) {
+				using std::swap;
+				size_t i = start, j = mid;
+				u64 bits = 0;
+				int remaining_bits = 0;
+				while (true) {
+					if (remaining_bits == 0) {
+						bits = engine();
+						remaining_bits = 64;
+					}
+					bool take_right = bits & 1;
+					bits >>= 1;
+					--remaining_bits;
+					if (take_right) {
+						if (j == end) {
+							break;
+						}
+						swap(first[i], first[j]);
+						++j;
+					}
+					else if (i == j) {
+						break;
+					}
+					++i;
+				}
+				for (; i < end; ++i) {
+					size_t k = start + static_cast<size_t>(bounded(engine, i - start + 1));
+					swap(first[i], first[k]);
+				}
+			}
+
+			// 并行洗牌的默认分块元素数，与线程数无关以保证结果可复现
+			constexpr size_t default_shuffle_grain = size_t(1) << 16;
+
+			// 并行洗牌中第 level 轮第 index 个任务使用的 Philox 流
+			inline u64 shuffle_stream(u64 level, u64 index) {
+				return (level << 48) | index;
+			}
+		}
+
+		// 并行洗牌（MergeShuffle）：按 grain 分块并行 Fisher-Yates，再逐轮并行两两合并。
+		// 每个任务使用独立的 Philox 流（key 为 seed），结果只取决于 seed 与 grain，与线程数和调度无关。
+		// grain 为 0 时使用固定的 local::default_shuffle_grain。
+		// 最后一轮合并是单线程的 O(n)，总体可扩展性与 parallel_sort 相当
+		template <typename RandomIt>
+		void parallel_shuffle(RandomIt first, RandomIt last, u64 seed_value, size_t grain = 0,
+			thread_pool::executor& executor_ = thread_pool::default_executor()) {
+			size_t size = static_cast<size_t>(std::distance(first, last));
+			if (grain == 0) {
+				grain = local::default_shuffle_grain;
+			}
+			if (size <= grain) {
+				philox4x32 engine(seed_value, local::shuffle_stream(0, 0));
+				shuffle(first, last, engine);
+				return;
+			}
+
+			size_t blocks = parallel::chunk_count(size, grain);
+			auto shuffle_block = [&](size_t index) {
+				auto r = parallel::chunk_range(size, grain, index);
+				philox4x32 engine(seed_value, local::shuffle_stream(0, index));
+				shuffle(first + r.begin, first + r.end, engine);
+				};
+			parallel::local::run_chunks(blocks, shuffle_block, executor_);
+
+			u64 level = 1;
+			for (size_t width = grain; width < size; width *= 2, ++level) {
+				size_t pairs = (size + 2 * width - 1) / (2 * width);
+				auto merge_pair = [&](size_t index) {
+					size_t start = index * 2 * width;
+					size_t mid = std::min(start + width, size);
+					size_t end = std::min(start + 2 * width, size);
+					if (mid < end) {
+						philox4x32 engine(seed_value, local::shuffle_stream(level, index));
+						local::merge_shuffled(first, start, mid, end, engine);
+					}
+					};
+				parallel::local::run_chunks(pairs, merge_pair, executor_);
+			}
+		}
+
+		// 蓄水池抽样（Li 1994 的 Algorithm L）：从长度未知的流中等概率抽取 capacity 个元素，
+		// 跳过的元素数按几何分布直接算出，期望只需 O(k (1 + log(n / k))) 次随机数。
+		// 多个线程各自抽样后可用 merge() 合并，结果仍是总体上的均匀抽样。Engine 可以是引用类型
+		template <typename T, typename Engine>
+		class reservoir_sampler {
+		public:
+			reservoir_sampler(size_t capacity, Engine engine) : capacity_(capacity), engine_(std::forward<Engine>(engine)) {
+				samples_.reserve(capacity_);
+				restart();
+			}
+
+			void offer(const T& value) {
+				emplace(value);
+			}
+			void offer(T&& value) {
+				emplace(std::move(value));
+			}
+
+			// 还需跳过多少个元素才会有元素被选中，调用方可据此直接跳过输入
+			u64 pending_skip() const {
+				return seen_ < capacity_ || merged_ ? 0 : next_ - seen_;
+			}
+
+			// 告知已跳过 count 个元素（count 不超过 pending_skip()）
+			void skip_elements(u64 count) {
+				seen_ += count;
+			}
+
+			// 合并另一个抽样器的结果，两者容量须相同。合并后 other 回到刚构造时的空状态，可继续抽样新的流
+			void merge(reservoir_sampler& other) {
+				std::vector<T> merged;
+				merged.reserve(capacity_);
+				u64 left_count = seen_, right_count = other.seen_;
+				size_t target = static_cast<size_t>(std::min<u64>(capacity_, left_count + right_count));
+				// 依次按剩余个数的比例决定从哪一侧抽取（超几何分布），再从该侧样本中随机取一个
+				while (merged.size() < target) {
+					auto& source = bounded(engine_, left_count + right_count) < left_count ? samples_ : other.samples_;
+					u64& count = &source == &samples_ ? left_count : right_count;
+					size_t index = static_cast<size_t>(bounded(engine_, source.size()));
+					merged.push_back(std::move(source[index]));
+					source[index] = std::move(source.back());
+					source.pop_back();
+					--count;
+				}
+				samples_ = std::move(merged);
+				seen_ += other.seen_;
+				other.samples_.clear();
+				other.restart();
+				// 合并后跳跃距离的分布依赖于已丢弃的元素，之后改为逐个判断（Algorithm R），仍然无偏
+				merged_ = true;
+			}
+
+			const std::vector<T>& samples() const {
+				return samples_;
+			}
+
+			u64 seen() const {
+				return seen_;
+			}
+
+		private:
+			// 重新开始跳跃计划，样本须已为空
+			void restart() {
+				seen_ = 0;
+				merged_ = false;
+				weight_ = next_weight();
+				next_ = capacity_ == 0 ? std::numeric_limits<u64>::max() : capacity_ - 1 + skip();
+			}
+
+			template <typename U>
+			void emplace(U&& value) {
+				if (samples_.size() < capacity_) {
+					samples_.push_back(std::forward<U>(value));
+				}
+				else if (merged_) {
+					u64 index = bounded(engine_, seen_ + 1);
+					if (index < capacity_) {
+						samples_[static_cast<size_t>(index)] = std::forward<U>(value);
+					}
+				}
+				else if (seen_ == next_) {
+					samples_[static_cast<size_t>(bounded(engine_, capacity_))] = std::forward<U>(value);
+					weight_ *= next_weight();
+					next_ += skip();
+				}
+				++seen_;
+			}
+
+			// W = U^(1/k)
+			f64 next_weight() {
+				return capacity_ == 0 ? 0 : local::deterministic_exp(local::deterministic_log(local::open_unit(engine_())) / static_cast<f64>(capacity_));
+			}
+
+			// 下一个被选中元素与当前位置的距离：floor(log(U) / log(1 - W)) + 1。
+			// W 极小时 1 - W 舍入为 1，商为 -inf 或 NaN，此时与过大的距离一样取上限
+			u64 skip() {
+				if (capacity_ == 0) {
+					return std::numeric_limits<u64>::max() / 2;
+				}
+				f64 gap = local::deterministic_log(local::open_unit(engine_())) / local::deterministic_log(1.0 - weight_);
+				return gap >= 0 && gap < 0x1.0p62 ? static_cast<u64>(gap) + 1 : u64(1) << 62;
+			}
+
+			size_t capacity_;
+			Engine engine_;
+			std::vector<T> samples_;
+			u64 seen_ = 0;
+			u64 next_ = 0;		// 下一个被选中元素的序号
+			f64 weight_ = 0;
+			bool merged_ = false;
+		};
+
+		// 从 [first, last) 中等概率抽取 count 个元素；随机访问迭代器会直接跳过不被选中的元素
+		template <typename InputIt, typename Engine>
+		auto reservoir_sample(InputIt first, InputIt last, size_t count, Engine& engine) {
+			using value_t = typename std::iterator_traits<InputIt>::value_type;
+			reservoir_sampler<value_t, Engine&> sampler(count, engine);
+			using category = typename std::iterator_traits<InputIt>::iterator_category;
+			if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>) {
+				while (first != last) {
+					u64 skip = std::min<u64>(sampler.pending_skip(), static_cast<u64>(last - first));
+					first += static_cast<std::ptrdiff_t>(skip);
+					sampler.skip_elements(skip);
+					if (first == last) {
+						break;
+					}
+					sampler.offer(*first);
+					++first;
+				}
+			}
+			else {
+				for (; first != last; ++first) {
+					sampler.offer(*first);
+				}
+			}
+			return sampler.samples();
+		}
+
+		// Vose 别名表：按权重在 O(1) 内抽取下标，构造 O(n)。
+		// 每个下标的接受阈值以 53 位定点数保存，抽样只用整数比较
+		class alias_table {
+		public:
+			// 权重须非负、有限且总和大于 0，否则抛出 std::invalid_argument
+			explicit alias_table(std::span<const f64> weights);
+
+			template <typename Engine>
+			size_t operator()(Engine& engine) const {
+				size_t index = static_cast<size_t>(bounded(engine, thresholds_.size()));
+				return (engine() >> 11) < thresholds_[index] ? index : aliases_[index];
+			}
+
+			// 批量抽样
+			template <typename Engine>
+			void sample(Engine& engine, std::span<size_t> out) const {
+				for (auto& value : out) {
+					value = (*this)(engine);
+				}
+			}
+
+			// 并行批量抽样，第 i 块使用 Philox 流 i，结果只取决于 seed 与 grain
+			void parallel_sample(std::span<size_t> out, u64 seed_value, size_t grain = 0,
+				thread_pool::executor& executor_ = thread_pool::default_executor()) const;
+
+			size_t size() const {
+				return thresholds_.size();
+			}
+
+			// 下标 index 被抽中的概率
+			f64 probability(size_t index) const;
+
+		private:
+			std::vector<u64> thresholds_;		// [0, 2^53]，2^53 表示总是接受本下标
+			std::vector<size_t> aliases_;
+		};
+
+		// 128 位 UUID（RFC 9562），按字节比较，UUIDv7 的字节序即时间顺序
+		struct uuid {
+			static constexpr size_t text_size = 36;
+
+			byte bytes[16];
+
+			// 以 8-4-4-4-12 小写十六进制写入 out（至少 text_size 字节，不追加结尾 0），返回写入的末尾
+			char* to_chars(char* out) const;
+			std::string to_string() const;
+
+			u8 version() const {
+				return bytes[6] >> 4;
+			}
+
+			// UUIDv7 中的 Unix 毫秒时间戳
+			u64 timestamp_ms() const;
+
+			auto operator<=>(const uuid&) const = default;
+		};
+
+		// 随机 UUIDv4，122 位随机数取自当前线程的 chacha20_csprng
+		uuid uuid_v4();
+		void uuid_v4(std::span<uuid> out);
+
+		// 按时间排序的 UUIDv7：48 位 Unix 毫秒时间戳 + 22 位计数 + 52 位随机数。
+		// 时间戳与计数保存在一个进程级原子变量中（ms << 22 | counter），以 CAS 无锁推进：
+		// 进入新的毫秒时计数从 21 位随机数开始，同一毫秒内递增，计数溢出时借用下一毫秒，
+		// 因此同一进程生成的 UUIDv7 严格递增。时间取自 tools::time::unix_milliseconds()，
+		// 系统时间回拨时沿用已记录的毫秒继续计数，直到系统时间追上
+		uuid uuid_v7();
+		// 批量生成，整批只需一次 CAS，结果依次递增
+		void uuid_v7(std::span<uuid> out);
+
+		// 随机数质量的快速冒烟检验，只能发现明显的缺陷（如 SIMD 实现写错了路、位被截断），不能代替 TestU01 / PractRand
+		struct quality_report {
+			u64 samples = 0;
+			f64 chi_squared = 0;			// 字节值直方图的卡方统计量，自由度 255
+			f64 max_bit_bias_z = 0;			// 64 个位各自出现 1 的频率偏离 1/2 的最大 |z|
+			f64 serial_correlation_z = 0;	// 相邻两值（视为 [0, 1) 实数）的滞后 1 相关系数乘以 sqrt(n)
+
+			// 各统计量都在 5 个标准差以内
+			bool passed() const;
+		};
+
+		quality_report check_quality(std::span<const u64> samples);
 	}
 
 
@@ -1,5 +1,8 @@
 #include "terminal.hpp"
 
+#include <algorithm>
+#include <cerrno>
+
 namespace tools {
 	namespace terminal
 	{
@@ -10,67 +13,438 @@ namespace tools {
 			return os; // Աʽ
 		}
 
-		void ShowCursor(bool showFlag)
+		namespace
 		{
+			// ׷ʮƷǸ iostream
+			void append_number(std::string& out, u32 value)
+			{
+				char digits[10];
+				i32 count = 0;
+				do
+				{
+					digits[count++] = static_cast<char>('0' + value % 10);
+					value /= 10;
+				} while (value != 0);
+				while (count > 0)
+				{
+					out.push_back(digits[--count]);
+				}
+			}
+
+			// ׷ UTF-8 ַЧΪ U+FFFD
+			void append_utf8(std::string& out, char32_t c)
+			{
+				if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+				{
+					c = 0xFFFD;
+				}
+				if (c < 0x80)
+				{
+					out.push_back(static_cast<char>(c));
+				}
+				else if (c < 0x800)
+				{
+					out.push_back(static_cast<char>(0xC0 | (c >> 6)));
+					out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+				}
+				else if (c < 0x10000)
+				{
+					out.push_back(static_cast<char>(0xE0 | (c >> 12)));
+					out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+					out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+				}
+				else
+				{
+					out.push_back(static_cast<char>(0xF0 | (c >> 18)));
+					out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+					out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+					out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+				}
+			}
+
+			// ַ UTF-8 ֽ append_utf8 һ
+			i32 utf8_length(char32_t c)
+			{
+				if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+				{
+					c = 0xFFFD;
+				}
+				return c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+			}
+
+			// ʮλ
+			i32 decimal_length(u32 value)
+			{
+				i32 count = 1;
+				while (value >= 10)
+				{
+					value /= 10;
+					++count;
+				}
+				return count;
+			}
+
+			// д׼дźж
+			void write_all(std::string_view data)
+			{
 #ifdef _WIN32
-			// Windows ϵͳʹ Windows API ƹ
-			HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-			CONSOLE_CURSOR_INFO cursorInfo;
-			GetConsoleCursorInfo(hOut, &cursorInfo);
-			cursorInfo.bVisible = showFlag;
-			SetConsoleCursorInfo(hOut, &cursorInfo);
+				HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+				DWORD mode = 0;
+				if (GetConsoleMode(hOut, &mode) && !(mode & ENABLE_VIRTUAL_TERMINAL_PROCESSING))
+				{
+					SetConsoleMode(hOut, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+				}
+				while (!data.empty())
+				{
+					DWORD written = 0;
+					if (!WriteFile(hOut, data.data(), static_cast<DWORD>(data.size()), &written, nullptr))
+					{
+						throw std::runtime_error("Failed to write to console.");
+					}
+					data.remove_prefix(written);
+				}
 #else
-			//  UNIX ϵͳʹ ANSI תпƹ
-			if (showFlag)
+				while (!data.empty())
+				{
+					ssize_t written = ::write(STDOUT_FILENO, data.data(), data.size());
+					if (written < 0)
+					{
+						if (errno == EINTR)
+						{
+							continue;
+						}
+						throw std::runtime_error("Failed to write to terminal.");
+					}
+					data.remove_prefix(static_cast<size_t>(written));
+				}
+#endif
+			}
+		}
+
+		command_builder::command_builder(size_t capacity)
+		{
+			buffer_.reserve(capacity);
+		}
+
+		void command_builder::number(u32 value)
+		{
+			append_number(buffer_, value);
+		}
+
+		void command_builder::close_sgr()
+		{
+			if (sgr_open_)
 			{
-				std::cout << "\033[?25h"; // ʾ
+				buffer_.push_back('m');
+				sgr_open_ = false;
+			}
+		}
+
+		//  SGR һ "\033[" ǰ׺ ';' ָʱ 'm'
+		void command_builder::sgr(u32 parameter)
+		{
+			if (sgr_open_)
+			{
+				buffer_.push_back(';');
 			}
 			else
 			{
-				std::cout << "\033[?25l"; // ع
+				buffer_.append("\033[");
+				sgr_open_ = true;
 			}
-			std::cout.flush(); // ȷˢն
-#endif
+			number(parameter);
+		}
+
+		// base Ϊ 30ǰ 40
+		void command_builder::sgr_color(const cell_color& color, u32 base)
+		{
+			switch (color.type)
+			{
+			case cell_color::kind::default_color:
+				sgr(base + 9);
+				break;
+			case cell_color::kind::indexed:
+				if (color.r < 8)
+				{
+					sgr(base + color.r);
+				}
+				else if (color.r < 16)
+				{
+					sgr(base + 60 + color.r - 8);
+				}
+				else
+				{
+					sgr(base + 8);
+					buffer_.append(";5;");
+					number(color.r);
+				}
+				break;
+			case cell_color::kind::rgb:
+				sgr(base + 8);
+				buffer_.append(";2;");
+				number(color.r);
+				buffer_.push_back(';');
+				number(color.g);
+				buffer_.push_back(';');
+				number(color.b);
+				break;
+			}
+		}
+
+		command_builder& command_builder::csi(i32 count, char command)
+		{
+			close_sgr();
+			if (count > 0)
+			{
+				buffer_.append("\033[");
+				number(static_cast<u32>(count));
+				buffer_.push_back(command);
+			}
+			return *this;
+		}
+
+		command_builder& command_builder::move_to(i32 x, i32 y)
+		{
+			close_sgr();
+			buffer_.append("\033[");
+			number(static_cast<u32>(std::max(y, 1)));
+			buffer_.push_back(';');
+			number(static_cast<u32>(std::max(x, 1)));
+			buffer_.push_back('H');
+			return *this;
+		}
+
+		command_builder& command_builder::move_up(i32 count)
+		{
+			return csi(count, 'A');
+		}
+
+		command_builder& command_builder::move_down(i32 count)
+		{
+			return csi(count, 'B');
+		}
+
+		command_builder& command_builder::move_right(i32 count)
+		{
+			return csi(count, 'C');
+		}
+
+		command_builder& command_builder::move_left(i32 count)
+		{
+			return csi(count, 'D');
+		}
+
+		command_builder& command_builder::home()
+		{
+			close_sgr();
+			buffer_.append("\033[H");
+			return *this;
+		}
+
+		command_builder& command_builder::clear_screen()
+		{
+			close_sgr();
+			buffer_.append("\033[2J");
+			return *this;
+		}
+
+		command_builder& command_builder::clear_scrollback()
+		{
+			close_sgr();
+			buffer_.append("\033[3J");
+			return *this;
+		}
+
+		command_builder& command_builder::clear_line()
+		{
+			close_sgr();
+			buffer_.append("\033[2K");
+			return *this;
+		}
+
+		command_builder& command_builder::clear_to_line_end()
+		{
+			close_sgr();
+			buffer_.append("\033[K");
+			return *this;
+		}
+
+		// ƶ ECHַƶҲдո
+		command_builder& command_builder::clear_region(i32 x, i32 y, i32 width, i32 height)
+		{
+			if (width <= 0)
+			{
+				return *this;
+			}
+			for (i32 row = 0; row < height; ++row)
+			{
+				move_to(x, y + row);
+				csi(width, 'X');
+			}
+			return *this;
+		}
+
+		command_builder& command_builder::show_cursor(bool show)
+		{
+			close_sgr();
+			buffer_.append(show ? "\033[?25h" : "\033[?25l");
+			return *this;
+		}
+
+		command_builder& command_builder::reset_style()
+		{
+			sgr(0);
+			return *this;
+		}
+
+		command_builder& command_builder::foreground(cell_color color)
+		{
+			sgr_color(color, 30);
+			return *this;
+		}
+
+		command_builder& command_builder::background(cell_color color)
+		{
+			sgr_color(color, 40);
+			return *this;
+		}
+
+		command_builder& command_builder::attributes_on(u8 attributes)
+		{
+			static constexpr struct { u8 flag; u8 code; } codes[] = {
+				{ attribute_bold, 1 }, { attribute_dim, 2 }, { attribute_italic, 3 },
+				{ attribute_underline, 4 }, { attribute_blink, 5 }, { attribute_reverse, 7 },
+			};
+			for (auto& code : codes)
+			{
+				if (attributes & code.flag)
+				{
+					sgr(code.code);
+				}
+			}
+			return *this;
+		}
+
+		command_builder& command_builder::attributes_off(u8 attributes)
+		{
+			if (attributes & (attribute_bold | attribute_dim))
+			{
+				sgr(22);
+			}
+			static constexpr struct { u8 flag; u8 code; } codes[] = {
+				{ attribute_italic, 23 }, { attribute_underline, 24 }, { attribute_blink, 25 }, { attribute_reverse, 27 },
+			};
+			for (auto& code : codes)
+			{
+				if (attributes & code.flag)
+				{
+					sgr(code.code);
+				}
+			}
+			return *this;
+		}
+
+		command_builder& command_builder::text(std::string_view content)
+		{
+			close_sgr();
+			buffer_.append(content);
+			return *this;
+		}
+
+		command_builder& command_builder::glyph(char32_t value)
+		{
+			close_sgr();
+			append_utf8(buffer_, value);
+			return *this;
+		}
+
+		std::string_view command_builder::view()
+		{
+			close_sgr();
+			return buffer_;
+		}
+
+		void command_builder::clear()
+		{
+			buffer_.clear();
+			sgr_open_ = false;
+		}
+
+		void command_builder::reserve(size_t capacity)
+		{
+			buffer_.reserve(capacity);
+		}
+
+		void command_builder::flush()
+		{
+			std::string_view data = view();
+			if (!data.empty())
+			{
+				std::cout.flush();
+				std::fflush(stdout);
+				write_all(data);
+			}
+			clear();
+		}
+
+		namespace
+		{
+			// ݺõֲ߳̾ÿε÷ڴ
+			command_builder& shared_builder()
+			{
+				thread_local command_builder builder(256);
+				builder.clear();
+				return builder;
+			}
+
+			// ݺ׳쳣ԭֱд std::cout ʱһдʧܣֻǷɹ
+			bool flush_quietly(command_builder& builder)
+			{
+				try
+				{
+					builder.flush();
+					return true;
+				}
+				catch (const std::runtime_error&)
+				{
+					return false;
+				}
+			}
+		}
+
+		void ShowCursor(bool showFlag)
+		{
+			flush_quietly(shared_builder().show_cursor(showFlag));
 		}
 
 		// ƶָλ (x, y)  1ʼ
 		void goto_xy(i32 x, i32 y)
 		{
-#ifdef _WIN32
-			HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-			COORD coord = { static_cast<SHORT>(x), static_cast<SHORT>(y) };
-			SetConsoleCursorPosition(hOut, coord);
-#else
-			std::cout << "\033[" << y << ";" << x << "H";
-#endif
+			flush_quietly(shared_builder().move_to(x, y));
 		}
 
-		// տ̨
+		// տ̨ clear ͬУӽ
 		i32 clear()
 		{
-#ifdef _WIN32
-			return system("cls");
-#else
-			return system("clear");
-#endif
+			return flush_quietly(shared_builder().home().clear_screen().clear_scrollback()) ? 0 : -1;
 		}
 
 		// ÿ̨ıǰɫ
 		void set_text_color(Color color)
 		{
-			std::cout << "\033[" << color + 30 << "m";
+			flush_quietly(shared_builder().foreground(color));
 		}
 
 		// ÿ̨ɫ
 		void set_background_color(Color color)
 		{
-			std::cout << "\033[" << color + 40 << "m";
+			flush_quietly(shared_builder().background(color));
 		}
 
 		// ÿ̨ɫ
 		void reset_color()
 		{
-			std::cout << "\033[0m";
+			flush_quietly(shared_builder().reset_style());
 		}
 
 		// ȡǰ
@@ -152,6 +526,214 @@ namespace tools {
 			return xy(w.ws_col, w.ws_row);
 #endif
 		}
+
+		screen_renderer::screen_renderer(i32 width, i32 height)
+			: width_(0), height_(0)
+		{
+			resize(width, height);
+		}
+
+		void screen_renderer::resize(i32 width, i32 height)
+		{
+			width_ = std::max(width, 0);
+			height_ = std::max(height, 0);
+			size_t count = static_cast<size_t>(width_) * static_cast<size_t>(height_);
+			back_.assign(count, cell());
+			front_.assign(count, cell());
+			full_redraw_ = true;
+			// Ԥһ֡ȫػĵͳȣ֮֡ٷ
+			output_.reserve(count * 4 + static_cast<size_t>(height_) * 16);
+		}
+
+		void screen_renderer::invalidate()
+		{
+			full_redraw_ = true;
+		}
+
+		void screen_renderer::clear(const cell& fill)
+		{
+			std::fill(back_.begin(), back_.end(), fill);
+		}
+
+		cell& screen_renderer::at(i32 x, i32 y)
+		{
+			if (x < 0 || y < 0 || x >= width_ || y >= height_)
+			{
+				throw std::out_of_range("screen_renderer::at: position out of range.");
+			}
+			return back_[static_cast<size_t>(y) * width_ + x];
+		}
+
+		const cell& screen_renderer::at(i32 x, i32 y) const
+		{
+			if (x < 0 || y < 0 || x >= width_ || y >= height_)
+			{
+				throw std::out_of_range("screen_renderer::at: position out of range.");
+			}
+			return back_[static_cast<size_t>(y) * width_ + x];
+		}
+
+		void screen_renderer::set(i32 x, i32 y, const cell& value)
+		{
+			if (x >= 0 && y >= 0 && x < width_ && y < height_)
+			{
+				back_[static_cast<size_t>(y) * width_ + x] = value;
+			}
+		}
+
+		void screen_renderer::text(i32 x, i32 y, std::u32string_view content, cell_color foreground,
+			cell_color background, u8 attributes)
+		{
+			if (y < 0 || y >= height_)
+			{
+				return;
+			}
+			for (char32_t glyph : content)
+			{
+				if (x >= width_)
+				{
+					break;
+				}
+				if (x >= 0)
+				{
+					back_[static_cast<size_t>(y) * width_ + x] = cell{ glyph, foreground, background, attributes };
+				}
+				++x;
+			}
+		}
+
+		void screen_renderer::move_to(i32 x, i32 y)
+		{
+			if (cursor_known_ && cursor_x_ == x && cursor_y_ == y)
+			{
+				return;
+			}
+			output_.move_to(x + 1, y + 1);
+			cursor_known_ = true;
+			cursor_x_ = x;
+			cursor_y_ = y;
+		}
+
+		void screen_renderer::emit_style(const cell& value)
+		{
+			// ڵ SGR  command_builder ϲΪһ
+			if (!pen_known_ || (value.foreground == cell_color() && value.background == cell_color()
+				&& value.attributes == attribute_none))
+			{
+				// ״̬δ֪صĬʽʱȫλֻ֮ҪĲ
+				output_.reset_style();
+				pen_ = pen();
+				pen_known_ = true;
+			}
+
+			u8 turned_off = pen_.attributes & ~value.attributes;
+			u8 turned_on = value.attributes & ~pen_.attributes;
+			if (turned_off & (attribute_bold | attribute_dim))
+			{
+				// 22 ͬʱرմ밵豣´
+				turned_on |= value.attributes & (attribute_bold | attribute_dim);
+			}
+			output_.attributes_off(turned_off);
+			output_.attributes_on(turned_on);
+
+			if (!(pen_.foreground == value.foreground))
+			{
+				output_.foreground(value.foreground);
+			}
+			if (!(pen_.background == value.background))
+			{
+				output_.background(value.background);
+			}
+
+			pen_.foreground = value.foreground;
+			pen_.background = value.background;
+			pen_.attributes = value.attributes;
+		}
+
+		bool screen_renderer::rewrite_gap(const cell* row, i32 x, i32 y) const
+		{
+			if (!cursor_known_ || !pen_known_ || cursor_y_ != y || cursor_x_ >= x || x - cursor_x_ > max_gap)
+			{
+				return false;
+			}
+			// мĵԪ뵱ǰʽͬдҪлʽ
+			i32 rewrite = 0;
+			for (i32 gap = cursor_x_; gap < x; ++gap)
+			{
+				const cell& value = row[gap];
+				if (!(value.foreground == pen_.foreground) || !(value.background == pen_.background)
+					|| value.attributes != pen_.attributes)
+				{
+					return false;
+				}
+				rewrite += utf8_length(value.glyph);
+			}
+			// ƶΪ ESC [  ;  H
+			i32 move = 4 + decimal_length(static_cast<u32>(y) + 1) + decimal_length(static_cast<u32>(x) + 1);
+			return rewrite <= move;
+		}
+
+		void screen_renderer::emit_cell(const cell& value)
+		{
+			if (!pen_known_ || !(pen_.foreground == value.foreground) || !(pen_.background == value.background)
+				|| pen_.attributes != value.attributes)
+			{
+				emit_style(value);
+			}
+			output_.glyph(value.glyph);
+			++cursor_x_;
+			if (cursor_x_ >= width_)
+			{
+				// дһкն˵ĹΪһ£ӳٻУΪδ֪
+				cursor_known_ = false;
+			}
+		}
+
+		std::string_view screen_renderer::render()
+		{
+			output_.clear();
+			cursor_known_ = false;
+			pen_known_ = false;
+
+			for (i32 y = 0; y < height_; ++y)
+			{
+				const cell* back_row = back_.data() + static_cast<size_t>(y) * width_;
+				const cell* front_row = front_.data() + static_cast<size_t>(y) * width_;
+				for (i32 x = 0; x < width_; ++x)
+				{
+					if (!full_redraw_ && back_row[x] == front_row[x])
+					{
+						continue;
+					}
+					// ͬһֻ뻭ͬʽδ䵥Ԫʱֱдǲƶ곤
+					if (rewrite_gap(back_row, x, y))
+					{
+						for (i32 gap = cursor_x_; gap < x; ++gap)
+						{
+							emit_cell(back_row[gap]);
+						}
+					}
+					move_to(x, y);
+					emit_cell(back_row[x]);
+				}
+			}
+
+			if (pen_known_ && !(pen_.foreground == cell_color() && pen_.background == cell_color()
+				&& pen_.attributes == attribute_none))
+			{
+				output_.reset_style();
+			}
+
+			front_ = back_;
+			full_redraw_ = false;
+			return output_.view();
+		}
+
+		void screen_renderer::present()
+		{
+			render();
+			output_.flush();
+		}
 	}
 
 #ifdef tools_debug
@@ -192,6 +774,119 @@ namespace tools {
 			xy size = get_size();
 			std::cout << "ǰն˴СΪ: (" << size.x << ", " << size.y << ")" << std::endl;
 		}
+
+		// ԲȾдնˣ
+		u64 screen_renderer_test()
+		{
+			using namespace tools::terminal;
+
+			// ļΪ GBK 룬ַͨд
+			constexpr u64 result_error = \u7ed3\u679c\u9519\u8bef;
+			u64 error = 0;
+			screen_renderer renderer(8, 2);
+
+			// һ֡ȫػ棬Ĭɫֻһθλ
+			std::string first(renderer.render());
+			if (first != "\033[1;1H\033[0m        \033[2;1H        ")
+			{
+				error |= result_error;
+			}
+
+			// ݲʱû
+			if (!renderer.render().empty())
+			{
+				error |= result_error;
+			}
+
+			// Ԫ仯ֻһƶ͸ַ
+			renderer.set(3, 1, cell{ U'x' });
+			if (renderer.render() != "\033[2;4H\033[0mx")
+			{
+				error |= result_error;
+			}
+
+			// ͬʽһֻһ SGRмδ䵥Ԫʽ뻭ʲͬʱƶ꣬лʽд
+			renderer.text(0, 0, U"ab", Red, cell_color::rgb(1, 2, 3), attribute_bold | attribute_underline);
+			renderer.set(4, 0, cell{ U'\u00e9', Red, cell_color::rgb(1, 2, 3), attribute_bold | attribute_underline });
+			if (renderer.render() != "\033[1;1H\033[0;1;4;31;48;2;1;2;3mab\033[1;5H\xc3\xa9\033[0m")
+			{
+				error |= result_error;
+			}
+
+			// мδ䵥Ԫ뻭ʽͬʱֱдƶ
+			renderer.set(0, 1, cell{ U'p' });
+			renderer.set(4, 1, cell{ U'q' });
+			if (renderer.render() != "\033[2;1H\033[0mp  xq")
+			{
+				error |= result_error;
+			}
+
+			// ֻı䲿ʱֻ
+			renderer.text(0, 0, U"a", cell_color::indexed(200), cell_color::rgb(1, 2, 3), attribute_bold);
+			renderer.text(1, 0, U"b", cell_color::indexed(200), cell_color::rgb(1, 2, 3), attribute_dim);
+			if (renderer.render() != "\033[1;1H\033[0;1;38;5;200;48;2;1;2;3ma\033[22;2mb\033[0m")
+			{
+				error |= result_error;
+			}
+
+			// Խд뱻ԣresize ȫػ
+			renderer.set(100, 100, cell{ U'z' });
+			renderer.resize(2, 1);
+			if (renderer.render() != "\033[1;1H\033[0m  ")
+			{
+				error |= result_error;
+			}
+			return error;
+		}
+		// Կйдնˣ
+		u64 command_builder_test()
+		{
+			using namespace tools::terminal;
+
+			// ļΪ GBK 룬ַͨд
+			constexpr u64 result_error = \u7ed3\u679c\u9519\u8bef;
+			u64 error = 0;
+			command_builder builder(64);
+
+			//  SGR ϲΪһǰԶ
+			builder.reset_style().attributes_on(attribute_bold | attribute_reverse).foreground(Red)
+				.background(cell_color::indexed(12)).text("a").foreground(cell_color::rgb(255, 0, 7)).background(Default);
+			if (builder.view() != "\033[0;1;7;31;104ma\033[38;2;255;0;7;49m")
+			{
+				error |= result_error;
+			}
+
+			// ƶ
+			builder.clear();
+			builder.move_to(3, 5).move_up(2).move_left(0).clear_line().clear_to_line_end().show_cursor(false)
+				.home().clear_screen().clear_scrollback();
+			if (builder.view() != "\033[5;3H\033[2A\033[2K\033[K\033[?25l\033[H\033[2J\033[3J")
+			{
+				error |= result_error;
+			}
+
+			// ʹ ECH
+			builder.clear();
+			builder.clear_region(2, 3, 4, 2).glyph(U'\u4e2d');
+			if (builder.view() != "\033[3;2H\033[4X\033[4;2H\033[4X\xe4\xb8\xad")
+			{
+				error |= result_error;
+			}
+
+			// ֮ڷ첻ٷڴ
+			builder.clear();
+			const char* data = builder.view().data();
+			for (i32 i = 0; i < 4; ++i)
+			{
+				builder.clear();
+				builder.move_to(80, 24).foreground(cell_color::rgb(255, 255, 255)).text("0123456789");
+			}
+			if (builder.view().data() != data)
+			{
+				error |= result_error;
+			}
+			return error;
+		}
 	}
 #endif
 }
\ No newline at end of file
@@ -15,6 +15,9 @@ namespace tools {
 		//  `operator<<`  `xy` 
 		std::ostream& operator<<(std::ostream& os, const xy& obj);
 
+		// еıݺShowCursorgoto_xyclearset_text_colorset_background_colorreset_color
+		// ׳쳣дʧʱĬԣ clear ͨ -1 棻Ҫʱʹ command_builder::flush()
+
 		// ƿ̨Ƿʾ
 		void ShowCursor(bool showFlag);
 
@@ -32,10 +35,10 @@ namespace tools {
 			Default
 		};
 
-		// ƶָλ (x, y)
+		// ƶָλ (x, y)  1ʼ
 		void goto_xy(i32 x, i32 y);
 
-		// տ̨
+		// տ̨ع岢ѹƵϽǣɹ 0
 		i32 clear();
 
 		// ÿ̨ıǰɫ
@@ -52,6 +55,202 @@ namespace tools {
 
 		// ȡն˴С
 		xy get_size();
+
+		// ַԣɰλ
+		enum attribute : u8
+		{
+			attribute_none = 0,
+			attribute_bold = 1 << 0,
+			attribute_dim = 1 << 1,
+			attribute_italic = 1 << 2,
+			attribute_underline = 1 << 3,
+			attribute_blink = 1 << 4,
+			attribute_reverse = 1 << 5,
+		};
+
+		// ԪɫնĬɫ256 ɫɫ±꣨0~15 Ϊ׼ 16 ɫ 24 λɫ
+		struct cell_color
+		{
+			enum class kind : u8 { default_color, indexed, rgb };
+
+			kind type = kind::default_color;
+			u8 r = 0;		// indexed ʱΪɫ±
+			u8 g = 0;
+			u8 b = 0;
+
+			cell_color() = default;
+			cell_color(Color color)
+			{
+				if (color != Default)
+				{
+					type = kind::indexed;
+					r = static_cast<u8>(color);
+				}
+			}
+
+			static cell_color indexed(u8 index)
+			{
+				cell_color color;
+				color.type = kind::indexed;
+				color.r = index;
+				return color;
+			}
+
+			static cell_color rgb(u8 r_, u8 g_, u8 b_)
+			{
+				cell_color color;
+				color.type = kind::rgb;
+				color.r = r_;
+				color.g = g_;
+				color.b = b_;
+				return color;
+			}
+
+			bool operator==(const cell_color&) const = default;
+		};
+
+		// Ļϵһַλãglyph Ϊпַ
+		struct cell
+		{
+			char32_t glyph = U' ';
+			cell_color foreground;
+			cell_color background;
+			u8 attributes = attribute_none;
+
+			bool operator==(const cell&) const = default;
+		};
+
+		// ն˿йѹƶ/SGR16/256/ɫַԣ͹
+		// ׷ӵԤȷĻflush() һ write() д clear()/flush() 
+		// ʱٷڴ档 SGR ԶϲΪһС 1 ʼ goto_xy һ
+		class command_builder
+		{
+		public:
+			explicit command_builder(size_t capacity = 4096);
+
+			// ƶ
+			command_builder& move_to(i32 x, i32 y);
+			command_builder& move_up(i32 count = 1);
+			command_builder& move_down(i32 count = 1);
+			command_builder& move_right(i32 count = 1);
+			command_builder& move_left(i32 count = 1);
+			command_builder& home();
+
+			// Ļ / ع / Уλò
+			command_builder& clear_screen();
+			command_builder& clear_scrollback();
+			command_builder& clear_line();
+			// ӹ괦β
+			command_builder& clear_to_line_end();
+			//  (x, y) ΪϽǡwidth  height ľ򣬽λδ
+			command_builder& clear_region(i32 x, i32 y, i32 width, i32 height);
+
+			command_builder& show_cursor(bool show);
+
+			// SGRλǰɫɫ / رַ
+			command_builder& reset_style();
+			command_builder& foreground(cell_color color);
+			command_builder& background(cell_color color);
+			command_builder& attributes_on(u8 attributes);
+			// 밵ùر 22ر֮һͬʱر
+			command_builder& attributes_off(u8 attributes);
+
+			// ıglyph  UTF-8 
+			command_builder& text(std::string_view content);
+			command_builder& glyph(char32_t value);
+
+			// ѹֽУصͼһ޸ǰЧ
+			std::string_view view();
+			bool empty() const { return buffer_.empty(); }
+
+			// ѹ
+			void clear();
+
+			// ֤Ϊ capacity
+			void reserve(size_t capacity);
+
+			// ˢ std::cout Ա˳ٰһд׼գʧʱ׳ std::runtime_error
+			void flush();
+
+		private:
+			void sgr(u32 parameter);
+			void sgr_color(const cell_color& color, u32 base);
+			void close_sgr();
+			void number(u32 value);
+			command_builder& csi(i32 count, char command);
+
+			std::string buffer_;
+			bool sgr_open_ = false;
+		};
+
+		// ˫ĲȾں̨л֡render() һ֡Ƚϣֻ仯ĵԪ
+		// ڵı仯ϲһм䲻 max_gap δ䵥Ԫʽ뵱ǰͬдƶ곤ʱֱд
+		// ɫֻ뵱ǰʲͬʱҺϲΪһ SGR Уpresent() һ write() д֡
+		//  0 ʼÿ֡ʼʱٶն˵Ĺ뻭״̬ʱָĬɫ
+		class screen_renderer
+		{
+		public:
+			static constexpr i32 max_gap = 4;
+
+			screen_renderer(i32 width, i32 height);
+
+			i32 width() const { return width_; }
+			i32 height() const { return height_; }
+
+			// ıߴ磬ԭݶһ֡ȫػ
+			void resize(i32 width, i32 height);
+
+			// һ֡ȫػ棨ն˱Ū֮
+			void invalidate();
+
+			//  fill ̨
+			void clear(const cell& fill = cell());
+
+			// ̨еĵԪԽʱ׳ std::out_of_range
+			cell& at(i32 x, i32 y);
+			const cell& at(i32 x, i32 y) const;
+
+			// õԪԽʱ
+			void set(i32 x, i32 y, const cell& value);
+
+			//  (x, y) дıұ߽Ĳֽض
+			void text(i32 x, i32 y, std::u32string_view content, cell_color foreground = cell_color(),
+				cell_color background = cell_color(), u8 attributes = attribute_none);
+
+			// ɱ֡һ֡Ĳѱ֡Ϊʾдնˣصͼһ render() ǰЧ
+			std::string_view render();
+
+			// render() ͨһ write() д׼ˢ std::cout Ա˳
+			void present();
+
+		private:
+			struct pen
+			{
+				cell_color foreground;
+				cell_color background;
+				u8 attributes = attribute_none;
+			};
+
+			void move_to(i32 x, i32 y);
+			//  y е x ֮δ䵥ԪǷӦֱдƶ
+			bool rewrite_gap(const cell* row, i32 x, i32 y) const;
+			void emit_cell(const cell& value);
+			void emit_style(const cell& value);
+
+			i32 width_;
+			i32 height_;
+			std::vector<cell> back_;		// ڻƵ֡
+			std::vector<cell> front_;		// նϵǰʾ֡
+			bool full_redraw_ = true;
+			command_builder output_;
+
+			// ն˵״̬known Ϊ false ʱʾδ֪
+			bool cursor_known_ = false;
+			i32 cursor_x_ = 0;
+			i32 cursor_y_ = 0;
+			bool pen_known_ = false;
+			pen pen_;
+		};
 	}
 
 
@@ -61,6 +260,12 @@ namespace tools {
 	{
 		// նع
 		void test_terminal_functions();
+
+		// ԲȾдնˣ
+		u64 screen_renderer_test();
+
+		// Կйдնˣ
+		u64 command_builder_test();
 	}
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "thread_pool.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace tools {
+	namespace thread_pool {
+		namespace {
+			// 当前线程所属的线程池及工作线程序号
+			thread_local executor* current_executor = nullptr;
+			thread_local u32 current_index = 0;
+
+			// 将线程绑定到指定 CPU 核心，失败时忽略
+			void pin_thread(std::thread& thread, u32 cpu) {
+#if defined(_WIN32)
+				SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << (cpu % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				CPU_SET(cpu % CPU_SETSIZE, &set);
+				pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+				(void)thread;
+				(void)cpu;
+#endif
+			}
+		}
+
+		executor::executor(config config_) : config_(config_) {
+			u32 count = this->config_.threads;
+			if (count == 0) {
+				count = std::thread::hardware_concurrency();
+			}
+			if (count == 0) {
+				count = 2;
+			}
+
+			workers_.reserve(count);
+			for (u32 i = 0; i < count; ++i) {
+				workers_.emplace_back(std::make_unique<worker>());
+			}
+			u32 cpu_count = std::max(1u, std::thread::hardware_concurrency());
+			for (u32 i = 0; i < count; ++i) {
+				workers_[i]->thread = std::thread(&executor::worker_loop, this, i);
+				if (this->config_.pin_threads) {
+					pin_thread(workers_[i]->thread, i % cpu_count);
+				}
+			}
+		}
+
+		executor::~executor() {
+			{
+				std::lock_guard<std::mutex> guard(sleep_mutex_);
+				stop_.store(true);
+			}
+			sleep_cv_.notify_all();
+			for (auto& worker_ : workers_) {
+				if (worker_->thread.joinable()) {
+					worker_->thread.join();
+				}
+			}
+		}
+
+		void executor::post_task(local::task_base* task) {
+			pending_.fetch_add(1);
+			if (current_executor == this) {
+				workers_[current_index]->deque.push(task);
+			}
+			else {
+				std::lock_guard<std::mutex> guard(inject_mutex_);
+				inject_.push_back(task);
+			}
+
+			if (sleeping_.load() > 0) {
+				{
+					std::lock_guard<std::mutex> guard(sleep_mutex_);
+				}
+				sleep_cv_.notify_one();
+			}
+		}
+
+		bool executor::take_task(local::task_base*& task) {
+			bool is_worker = current_executor == this;
+
+			// 先取自身队列
+			if (is_worker && workers_[current_index]->deque.pop(task)) {
+				return true;
+			}
+
+			// 再取共享注入队列
+			{
+				std::lock_guard<std::mutex> guard(inject_mutex_);
+				if (!inject_.empty()) {
+					task = inject_.front();
+					inject_.pop_front();
+					return true;
+				}
+			}
+
+			// 最后从其他工作线程窃取
+			u32 count = static_cast<u32>(workers_.size());
+			u32 start = is_worker ? current_index + 1 : 0;
+			for (u32 i = 0; i < count; ++i) {
+				u32 victim = (start + i) % count;
+				if (is_worker && victim == current_index) {
+					continue;
+				}
+				if (workers_[victim]->deque.steal(task)) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool executor::run_one() {
+			local::task_base* task = nullptr;
+			if (!take_task(task)) {
+				return false;
+			}
+			pending_.fetch_sub(1);
+			task->run();
+			delete task;
+			return true;
+		}
+
+		u32 executor::size() const {
+			return static_cast<u32>(workers_.size());
+		}
+
+		executor* executor::current() {
+			return current_executor;
+		}
+
+		void executor::worker_loop(u32 index) {
+			current_executor = this;
+			current_index = index;
+
+			while (true) {
+				if (run_one()) {
+					continue;
+				}
+				if (pending_.load() > 0) {
+					// 任务已计数但尚未入队，稍后重试
+					std::this_thread::yield();
+					continue;
+				}
+				if (stop_.load()) {
+					break;
+				}
+
+				std::unique_lock<std::mutex> guard(sleep_mutex_);
+				sleeping_.fetch_add(1);
+				sleep_cv_.wait(guard, [this]() { return stop_.load() || pending_.load() > 0; });
+				sleeping_.fetch_sub(1);
+			}
+
+			current_executor = nullptr;
+		}
+
+		executor& default_executor() {
+			static executor instance;
+			return instance;
+		}
+	}
+
+	namespace test {
+#ifdef tools_debug
+		u64 thread_pool_test() {
+			using namespace tools::thread_pool;
+
+			u64 error = 0;
+			executor executor_(config{ 4, false });
+
+			// 递归提交任务，验证工作线程内提交与窃取
+			std::function<u64(u64)> fib = [&](u64 n) -> u64 {
+				if (n < 2) {
+					return n;
+				}
+				auto left = executor_.submit(fib, n - 1);
+				u64 right = fib(n - 2);
+				return left.get() + right;
+				};
+			if (executor_.submit(fib, 20).get() != 6765) {
+				error |= 结果错误;
+			}
+
+			// 延续与异常传递
+			auto chained = executor_.submit([]() { return 20; })
+				.then([](future<i32> f) { return f.get() + 1; }, executor_)
+				.then([](future<i32> f) { return f.get() * 2; }, executor_);
+			if (chained.get() != 42) {
+				error |= 结果错误;
+			}
+			auto failed = executor_.submit([]() -> i32 { throw std::runtime_error("task failed"); });
+			try {
+				failed.get();
+				error |= 结果错误;
+			}
+			catch (const std::runtime_error&) {
+			}
+
+			// 等待一组任务
+			std::atomic<u64> counter{ 0 };
+			std::vector<future<void>> futures;
+			for (i32 i = 0; i < 1000; ++i) {
+				futures.push_back(executor_.submit([&counter]() { counter.fetch_add(1); }));
+			}
+			when_all(std::move(futures), executor_).get();
+			if (counter.load() != 1000) {
+				error |= 结果错误;
+			}
+
+			// 以左值提交的可调用对象被复制，原对象仍可继续使用
+			const auto increment = [&counter]() { counter.fetch_add(1); };
+			for (i32 i = 0; i < 100; ++i) {
+				executor_.post(increment);
+			}
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (counter.load() != 1100 && std::chrono::steady_clock::now() < deadline) {
+				std::this_thread::yield();
+			}
+			increment();
+			if (counter.load() != 1101) {
+				error |= 结果错误;
+			}
+			return error;
+		}
+#endif
+	}
+}
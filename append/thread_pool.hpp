@@ -0,0 +1,472 @@
+#pragma once
+#include "../tools.hpp"
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <optional>
+#include <variant>
+#include <tuple>
+#include <functional>
+
+
+namespace tools {
+	namespace thread_pool {
+		class executor;
+
+		namespace local {
+			// 类型擦除的只移动任务
+			struct task_base {
+				virtual ~task_base() = default;
+				virtual void run() = 0;
+			};
+
+			template <typename F>
+			struct task_impl : task_base {
+				F f;
+				template <typename G>
+				task_impl(G&& g) : f(std::forward<G>(g)) {}
+				void run() override { f(); }
+			};
+
+			template <typename F>
+			task_base* make_task(F&& f) {
+				return new task_impl<std::decay_t<F>>(std::forward<F>(f));
+			}
+
+			// void 结果使用 std::monostate 占位
+			template <typename T>
+			using storage_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+			// future / promise 共享的状态
+			template <typename T>
+			struct shared_state {
+				std::mutex mutex;
+				std::condition_variable cv;
+				std::atomic<bool> ready{ false };
+				std::optional<storage_t<T>> value;
+				std::exception_ptr exception;
+				std::vector<std::pair<executor*, task_base*>> continuations;
+			};
+		}
+
+		// Chase-Lev 工作窃取双端队列
+		// 所有者线程在底部 push / pop（LIFO），其他线程从顶部 steal（FIFO）。
+		// 扩容时旧数组保留到队列析构，避免窃取者访问已释放的内存。
+		template <typename T>
+		class chase_lev_deque {
+			static_assert(std::is_trivially_copyable_v<T>, "chase_lev_deque requires a trivially copyable element type");
+
+			struct ring {
+				i64 capacity;
+				i64 mask;
+				std::unique_ptr<std::atomic<T>[]> items;
+
+				ring(i64 capacity_) : capacity(capacity_), mask(capacity_ - 1), items(new std::atomic<T>[capacity_]) {}
+
+				T get(i64 index) {
+					return items[index & mask].load(std::memory_order_relaxed);
+				}
+
+				void put(i64 index, T item) {
+					items[index & mask].store(item, std::memory_order_relaxed);
+				}
+
+				ring* grow(i64 bottom, i64 top) {
+					auto bigger = new ring(capacity * 2);
+					for (i64 i = top; i < bottom; ++i) {
+						bigger->put(i, get(i));
+					}
+					return bigger;
+				}
+			};
+
+		public:
+			// capacity 会向上取整为 2 的幂
+			chase_lev_deque(i64 capacity = 256) {
+				i64 real_capacity = 1;
+				while (real_capacity < capacity) {
+					real_capacity <<= 1;
+				}
+				ring_.store(new ring(real_capacity), std::memory_order_relaxed);
+			}
+
+			~chase_lev_deque() {
+				delete ring_.load(std::memory_order_relaxed);
+			}
+
+			chase_lev_deque(const chase_lev_deque&) = delete;
+			chase_lev_deque& operator=(const chase_lev_deque&) = delete;
+
+			// 压入底部（仅所有者线程）
+			void push(T item) {
+				i64 bottom = bottom_.load(std::memory_order_relaxed);
+				i64 top = top_.load(std::memory_order_acquire);
+				ring* current = ring_.load(std::memory_order_relaxed);
+				if (bottom - top > current->capacity - 1) {
+					retired_.emplace_back(current);
+					current = current->grow(bottom, top);
+					ring_.store(current, std::memory_order_release);
+				}
+				current->put(bottom, item);
+				std::atomic_thread_fence(std::memory_order_release);
+				bottom_.store(bottom + 1, std::memory_order_relaxed);
+			}
+
+			// 从底部弹出（仅所有者线程），队列为空时返回 false
+			bool pop(T& item) {
+				i64 bottom = bottom_.load(std::memory_order_relaxed) - 1;
+				ring* current = ring_.load(std::memory_order_relaxed);
+				bottom_.store(bottom, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				i64 top = top_.load(std::memory_order_relaxed);
+
+				if (top > bottom) {
+					bottom_.store(bottom + 1, std::memory_order_relaxed);
+					return false;
+				}
+				item = current->get(bottom);
+				if (top == bottom) {
+					// 只剩最后一个元素，与窃取者竞争
+					bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+					bottom_.store(bottom + 1, std::memory_order_relaxed);
+					return won;
+				}
+				return true;
+			}
+
+			// 从顶部窃取（任意线程），队列为空或竞争失败时返回 false
+			bool steal(T& item) {
+				i64 top = top_.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				i64 bottom = bottom_.load(std::memory_order_acquire);
+				if (top >= bottom) {
+					return false;
+				}
+				ring* current = ring_.load(std::memory_order_acquire);
+				T candidate = current->get(top);
+				if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+					return false;
+				}
+				item = candidate;
+				return true;
+			}
+
+			// 近似的元素数量
+			i64 size() const {
+				i64 bottom = bottom_.load(std::memory_order_relaxed);
+				i64 top = top_.load(std::memory_order_relaxed);
+				return bottom > top ? bottom - top : 0;
+			}
+
+			bool empty() const {
+				return size() == 0;
+			}
+
+		private:
+			alignas(64) std::atomic<i64> top_{ 0 };
+			alignas(64) std::atomic<i64> bottom_{ 0 };
+			alignas(64) std::atomic<ring*> ring_{ nullptr };
+			std::vector<std::unique_ptr<ring>> retired_;
+		};
+
+		template <typename T>
+		class promise;
+
+		// 线程池任务结果
+		// 在工作线程中等待时会协助执行其他任务，避免所有工作线程相互等待而死锁。
+		template <typename T>
+		class future {
+		public:
+			future() = default;
+			future(std::shared_ptr<local::shared_state<T>> state) : state_(std::move(state)) {}
+
+			future(future&&) = default;
+			future& operator=(future&&) = default;
+			future(const future&) = delete;
+			future& operator=(const future&) = delete;
+
+			bool valid() const {
+				return state_ != nullptr;
+			}
+
+			bool is_ready() const {
+				return state_ && state_->ready.load(std::memory_order_acquire);
+			}
+
+			// 等待结果就绪
+			void wait() const;
+
+			// 获取结果，只能调用一次；任务抛出的异常会在此重新抛出
+			T get() {
+				wait();
+				auto state = std::move(state_);
+				if (state->exception) {
+					std::rethrow_exception(state->exception);
+				}
+				if constexpr (!std::is_void_v<T>) {
+					return std::move(*state->value);
+				}
+			}
+
+			// 添加延续：结果就绪后在 executor_ 上以就绪的 future 调用 f，
+			// 返回 f 结果的 future；调用后当前 future 失效
+			template <typename F>
+			auto then(F&& f, executor& executor_);
+
+			template <typename F>
+			auto then(F&& f);
+
+		private:
+			std::shared_ptr<local::shared_state<T>> state_;
+		};
+
+		template <typename T>
+		class promise {
+		public:
+			promise() : state_(std::make_shared<local::shared_state<T>>()) {}
+
+			promise(promise&&) = default;
+			promise& operator=(promise&&) = default;
+			promise(const promise&) = delete;
+			promise& operator=(const promise&) = delete;
+
+			~promise() {
+				if (state_ && !state_->ready.load(std::memory_order_acquire)) {
+					set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+				}
+			}
+
+			future<T> get_future() {
+				return future<T>(state_);
+			}
+
+			template <typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+			void set_value(U value) {
+				fulfill([&]() { state_->value.emplace(std::move(value)); });
+			}
+
+			template <typename U = T, typename = std::enable_if_t<std::is_void_v<U>>>
+			void set_value() {
+				fulfill([&]() { state_->value.emplace(); });
+			}
+
+			void set_exception(std::exception_ptr exception) {
+				fulfill([&]() { state_->exception = exception; });
+			}
+
+		private:
+			template <typename F>
+			void fulfill(F&& store);
+
+			std::shared_ptr<local::shared_state<T>> state_;
+		};
+
+		// 线程池配置
+		struct config {
+			u32 threads = 0;			// 工作线程数，0 表示使用 hardware_concurrency()
+			bool pin_threads = false;	// 是否将工作线程绑定到 CPU 核心
+		};
+
+		// 工作窃取线程池
+		// 每个工作线程拥有一个 Chase-Lev 队列，工作线程内提交的任务压入自身队列，
+		// 外部线程提交的任务进入共享注入队列，空闲工作线程从其他队列窃取任务。
+		class executor {
+		public:
+			executor(config config_ = config());
+			~executor();
+
+			executor(const executor&) = delete;
+			executor& operator=(const executor&) = delete;
+
+			// 提交任务并返回结果的 future
+			template <typename F, typename... Args>
+			auto submit(F&& f, Args&&... args) {
+				using result_t = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+				promise<result_t> promise_;
+				auto result = promise_.get_future();
+				post([promise_ = std::move(promise_), f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+					try {
+						if constexpr (std::is_void_v<result_t>) {
+							std::apply(f, std::move(args));
+							promise_.set_value();
+						}
+						else {
+							promise_.set_value(std::apply(f, std::move(args)));
+						}
+					}
+					catch (...) {
+						promise_.set_exception(std::current_exception());
+					}
+					});
+				return result;
+			}
+
+			// 提交不关心结果的任务
+			template <typename F>
+			void post(F&& f) {
+				post_task(local::make_task(std::forward<F>(f)));
+			}
+
+			// 提交已构造的任务，线程池负责释放
+			void post_task(local::task_base* task);
+
+			// 尝试执行一个待处理任务，没有任务时返回 false
+			bool run_one();
+
+			// 工作线程数
+			u32 size() const;
+
+			// 当前线程所属的线程池，非工作线程返回 nullptr
+			static executor* current();
+
+		private:
+			struct worker {
+				chase_lev_deque<local::task_base*> deque;
+				std::thread thread;
+			};
+
+			bool take_task(local::task_base*& task);
+			void worker_loop(u32 index);
+
+			config config_;
+			std::vector<std::unique_ptr<worker>> workers_;
+
+			std::mutex inject_mutex_;
+			std::deque<local::task_base*> inject_;
+
+			std::atomic<i64> pending_{ 0 };
+			std::atomic<u32> sleeping_{ 0 };
+			std::atomic<bool> stop_{ false };
+			std::mutex sleep_mutex_;
+			std::condition_variable sleep_cv_;
+		};
+
+		// 进程共享的默认线程池
+		executor& default_executor();
+
+		template <typename T>
+		void future<T>::wait() const {
+			if (is_ready()) {
+				return;
+			}
+			// 工作线程内协助执行任务
+			if (auto current = executor::current()) {
+				while (!state_->ready.load(std::memory_order_acquire)) {
+					if (!current->run_one()) {
+						std::this_thread::yield();
+					}
+				}
+				return;
+			}
+			std::unique_lock<std::mutex> guard(state_->mutex);
+			state_->cv.wait(guard, [this]() { return state_->ready.load(std::memory_order_acquire); });
+		}
+
+		template <typename T>
+		template <typename F>
+		auto future<T>::then(F&& f, executor& executor_) {
+			using result_t = std::invoke_result_t<std::decay_t<F>, future<T>>;
+			promise<result_t> next;
+			auto result = next.get_future();
+			auto state = std::move(state_);
+			auto task = local::make_task([state, next = std::move(next), f = std::forward<F>(f)]() mutable {
+				try {
+					if constexpr (std::is_void_v<result_t>) {
+						f(future<T>(state));
+						next.set_value();
+					}
+					else {
+						next.set_value(f(future<T>(state)));
+					}
+				}
+				catch (...) {
+					next.set_exception(std::current_exception());
+				}
+				});
+
+			{
+				std::lock_guard<std::mutex> guard(state->mutex);
+				if (!state->ready.load(std::memory_order_acquire)) {
+					state->continuations.push_back({ &executor_, task });
+					return result;
+				}
+			}
+			executor_.post_task(task);
+			return result;
+		}
+
+		template <typename T>
+		template <typename F>
+		auto future<T>::then(F&& f) {
+			return then(std::forward<F>(f), default_executor());
+		}
+
+		template <typename T>
+		template <typename F>
+		void promise<T>::fulfill(F&& store) {
+			std::vector<std::pair<executor*, local::task_base*>> continuations;
+			{
+				std::lock_guard<std::mutex> guard(state_->mutex);
+				if (state_->ready.load(std::memory_order_relaxed)) {
+					throw std::future_error(std::future_errc::promise_already_satisfied);
+				}
+				store();
+				state_->ready.store(true, std::memory_order_release);
+				continuations.swap(state_->continuations);
+			}
+			state_->cv.notify_all();
+			for (auto& continuation : continuations) {
+				continuation.first->post_task(continuation.second);
+			}
+		}
+
+		// 所有 future 就绪后就绪；任一任务失败时传递第一个异常
+		template <typename T>
+		future<void> when_all(std::vector<future<T>> futures, executor& executor_ = default_executor()) {
+			struct latch {
+				std::atomic<size_t> remaining;
+				std::mutex mutex;
+				std::exception_ptr exception;
+				promise<void> done;
+			};
+			auto shared = std::make_shared<latch>();
+			shared->remaining.store(futures.size() + 1, std::memory_order_relaxed);
+			auto result = shared->done.get_future();
+
+			auto arrive = [](latch& l) {
+				if (l.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					if (l.exception) {
+						l.done.set_exception(l.exception);
+					}
+					else {
+						l.done.set_value();
+					}
+				}
+				};
+
+			for (auto& f : futures) {
+				f.then([shared, arrive](future<T> ready) {
+					try {
+						ready.get();
+					}
+					catch (...) {
+						std::lock_guard<std::mutex> guard(shared->mutex);
+						if (!shared->exception) {
+							shared->exception = std::current_exception();
+						}
+					}
+					arrive(*shared);
+					}, executor_);
+			}
+			arrive(*shared);
+			return result;
+		}
+	}
+
+	namespace test {
+#ifdef tools_debug
+		u64 thread_pool_test();
+#endif
+	}
+}
@@ -0,0 +1,8 @@
+#include "threaded_data_container.hpp"
+
+namespace tools {
+	namespace threaded_data_container {
+		// mcs_lock 每个线程的队列节点
+		thread_local mcs_lock::node mcs_lock::my_node;
+	}
+}
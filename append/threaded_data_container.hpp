@@ -44,7 +44,7 @@ namespace tools{
         class mcs_lock {
             struct node {
                 std::atomic<bool> waiting{ true };
-                node* next = nullptr;
+                std::atomic<node*> next{ nullptr };
             };
 
             std::atomic<node*> tail{ nullptr }; // βָ
@@ -52,9 +52,11 @@ namespace tools{
 
         public:
             void lock() {
-                node* prev = tail.exchange(&my_node, std::memory_order_acquire); // ԭӲµβڵ
+                my_node.next.store(nullptr, std::memory_order_relaxed);
+                my_node.waiting.store(true, std::memory_order_relaxed); // ýڵ㣬ڵڶμ临
+                node* prev = tail.exchange(&my_node, std::memory_order_acq_rel); // ԭӲµβڵ
                 if (prev) {
-                    prev->next = &my_node;
+                    prev->next.store(&my_node, std::memory_order_release);
                     while (my_node.waiting.load(std::memory_order_acquire)) {
                         // ȴǰͷ
                     }
@@ -62,17 +64,17 @@ namespace tools{
             }
 
             void unlock() {
-                if (!my_node.next) { // ûк߳
+                node* successor = my_node.next.load(std::memory_order_acquire);
+                if (!successor) { // ûк߳
                     node* expected = &my_node;
-                    if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_release)) {
+                    if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
                         return; // ûкֱ̣ͷ
                     }
-                    while (!my_node.next) {
+                    while (!(successor = my_node.next.load(std::memory_order_acquire))) {
                         // ȴ̽ڵָ뱻
                     }
                 }
-                my_node.next->waiting.store(false, std::memory_order_release); // ֪ͨ߳
-                my_node.next = nullptr; // Լ next
+                successor->waiting.store(false, std::memory_order_release); // ֪ͨ߳
             }
         };
 	}
@@ -270,9 +270,14 @@ namespace tools {
 			if (duration.count() <= 0) return; // 保护机制：负数或 0 持续时间直接返回
 
 			// 转换为目标时间点，然后调用 sleep_until
-			auto time_point = std::chrono::high_resolution_clock::now() + duration;
+			auto time_point = clock::now() + duration;
 			sleep_until(time_point, accuracy_level_);
 		}
+
+		u64 unix_milliseconds() {
+			auto now = std::chrono::system_clock::now().time_since_epoch();
+			return static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+		}
 	}
 
 
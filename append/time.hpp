@@ -73,6 +73,9 @@ namespace tools {
 		// 基于 `duration` 的睡眠函数（内部转换为 `time_point`）
 		void sleep_for(seconds_nano duration, accuracy_level accuracy_level_ = accuracy_level::lower);
 
+		// 当前 Unix 时间（毫秒），直接读取系统时钟，系统时间回拨时结果也会倒退
+		u64 unix_milliseconds();
+
 		class ticking_time
 		{
 		public:
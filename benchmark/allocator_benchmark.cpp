@@ -0,0 +1,536 @@
+// allocator_benchmark.cpp
+// 以接近真实的负载模式对比 memory_allocator 中各分配器与 malloc / new：
+// 短生命周期对象的持续替换、混合尺寸的批量分配与乱序释放、跨线程的生产者 / 消费者释放。
+// 输出吞吐量、延迟分位数以及测试期间的常驻内存（RSS）变化，
+// 同时校验每个块的内容，分配器返回重叠或损坏的内存时返回非 0。
+//
+// 用法: allocator_benchmark [输出 JSON 路径] [每组测试操作数] [--quick]
+#include "../tools.hpp"
+#include "../append/memory_allocator.hpp"
+#include "../append/time.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <deque>
+#include <condition_variable>
+
+
+namespace {
+	using namespace tools::memory_allocator;
+
+	// 分配失败时立即报错，避免后续的 stamp() 写入空指针
+	inline void* checked(void* ptr) {
+		if (ptr == nullptr) {
+			throw std::bad_alloc();
+		}
+		return ptr;
+	}
+
+	// 各分配器的统一接口，individual_free 为 false 的分配器只能整体回收，不参与持续替换测试
+	struct malloc_adapter {
+		static constexpr const char* name = "malloc";
+		static constexpr bool thread_safe = true;
+		static constexpr bool individual_free = true;
+		static constexpr u64 max_size = ~0ull;
+		void* allocate(u64 size) { return checked(std::malloc(size)); }
+		void deallocate(void* ptr, u64) { std::free(ptr); }
+		void round_end() {}
+	};
+
+	struct new_adapter {
+		static constexpr const char* name = "new";
+		static constexpr bool thread_safe = true;
+		static constexpr bool individual_free = true;
+		static constexpr u64 max_size = ~0ull;
+		void* allocate(u64 size) { return ::operator new(size); }
+		void deallocate(void* ptr, u64 size) { ::operator delete(ptr, size); }
+		void round_end() {}
+	};
+
+	struct system_adapter {
+		static constexpr const char* name = "system_allocator";
+		static constexpr bool thread_safe = false;
+		static constexpr bool individual_free = true;
+		static constexpr u64 max_size = ~0ull;
+		system_allocator allocator;
+		void* allocate(u64 size) { return checked(allocator.malloc_(size).start); }
+		void deallocate(void* ptr, u64 size) {
+			block<byte> raw(static_cast<byte*>(ptr), size);
+			allocator.free_(&raw);
+		}
+		void round_end() {}
+	};
+
+	// arena 不支持单个释放，每轮结束时整体回收
+	struct arena_adapter {
+		static constexpr const char* name = "arena_allocator";
+		static constexpr bool thread_safe = false;
+		static constexpr bool individual_free = false;
+		static constexpr u64 max_size = ~0ull;
+		arena_allocator allocator{ 1024 * 1024 };
+		void* allocate(u64 size) { return checked(allocator.malloc_(size).start); }
+		void deallocate(void*, u64) {}
+		void round_end() { allocator.reset(); }
+	};
+
+	// 对象池只服务定长请求
+	struct pool_adapter {
+		static constexpr const char* name = "pool_allocator";
+		static constexpr bool thread_safe = false;
+		static constexpr bool individual_free = true;
+		static constexpr u64 max_size = 64;
+		pool_allocator<std::array<byte, 64>> allocator;
+		void* allocate(u64) { return checked(allocator.allocate()); }
+		void deallocate(void* ptr, u64) { allocator.deallocate(static_cast<std::array<byte, 64>*>(ptr)); }
+		void round_end() {}
+	};
+
+	struct caching_adapter {
+		static constexpr const char* name = "caching_allocator";
+		static constexpr bool thread_safe = true;
+		static constexpr bool individual_free = true;
+		static constexpr u64 max_size = ~0ull;
+		caching_allocator allocator;
+		void* allocate(u64 size) { return checked(allocator.malloc_(size).start); }
+		void deallocate(void* ptr, u64) { allocator.free_(ptr); }
+		void round_end() {}
+	};
+
+	struct buddy_adapter {
+		static constexpr const char* name = "buddy_allocator";
+		static constexpr bool thread_safe = false;
+		static constexpr bool individual_free = true;
+		static constexpr u64 max_size = ~0ull;
+		buddy_allocator allocator{ u64(512) * 1024 * 1024, 16 };
+		void* allocate(u64 size) { return checked(allocator.malloc_(size).start); }
+		void deallocate(void* ptr, u64) { allocator.free_(ptr); }
+		void round_end() {}
+	};
+
+	// 当前进程的常驻内存字节数
+	u64 current_rss() {
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return counters.WorkingSetSize;
+		}
+		return 0;
+#else
+		std::ifstream statm("/proc/self/statm");
+		u64 pages = 0;
+		u64 resident = 0;
+		if (statm >> pages >> resident) {
+			return resident * static_cast<u64>(sysconf(_SC_PAGESIZE));
+		}
+		return 0;
+#endif
+	}
+
+	// 后台按固定间隔采样 RSS
+	class rss_sampler {
+	public:
+		rss_sampler() : begin_(tools::time::clock::now()) {
+			thread_ = std::thread([this]() {
+				std::unique_lock<std::mutex> guard(mutex_);
+				while (!stop_) {
+					guard.unlock();
+					auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(tools::time::clock::now() - begin_).count();
+					u64 rss = current_rss();
+					guard.lock();
+					samples_.push_back({ static_cast<u64>(elapsed), rss });
+					cv_.wait_for(guard, std::chrono::milliseconds(5), [this]() { return stop_; });
+				}
+				});
+		}
+
+		std::vector<std::pair<u64, u64>> stop() {
+			{
+				std::lock_guard<std::mutex> guard(mutex_);
+				stop_ = true;
+			}
+			cv_.notify_all();
+			thread_.join();
+			samples_.push_back({ static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(tools::time::clock::now() - begin_).count()), current_rss() });
+			return std::move(samples_);
+		}
+
+	private:
+		tools::time::clock::time_point begin_;
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		bool stop_ = false;
+		std::vector<std::pair<u64, u64>> samples_;
+		std::thread thread_;
+	};
+
+	struct case_result {
+		std::string allocator;
+		std::string pattern;
+		u32 threads = 1;
+		u64 operations = 0;
+		f64 seconds = 0;
+		f64 throughput = 0;			// 每秒分配 + 释放次数
+		u64 p50_ns = 0;
+		u64 p99_ns = 0;
+		u64 p999_ns = 0;
+		u64 rss_begin = 0;
+		u64 rss_peak = 0;
+		u64 rss_end = 0;
+		std::vector<std::pair<u64, u64>> rss_samples;	// (毫秒, 字节)
+		bool correct = true;
+	};
+
+	// 每 latency_stride 次操作计时一次，避免计时本身主导小块分配的开销
+	constexpr u64 latency_stride = 8;
+
+	// 尺寸分布：mixed 近似服务端常见的小对象为主、偶有大缓冲区的分布
+	std::vector<u64> make_sizes(const std::string& distribution, u64 count, u64 max_size, u64 seed) {
+		std::mt19937_64 rng(seed);
+		std::vector<u64> sizes(count);
+		for (auto& size : sizes) {
+			if (distribution == "fixed64") {
+				size = 64;
+				continue;
+			}
+			u64 roll = rng() % 100;
+			if (roll < 70) {
+				size = 16 + rng() % 113;			// 16 - 128
+			}
+			else if (roll < 95) {
+				size = 129 + rng() % 896;			// 129 - 1024
+			}
+			else if (roll < 99) {
+				size = 1025 + rng() % 15360;		// 1K - 16K
+			}
+			else {
+				size = 16385 + rng() % 114688;		// 16K - 128K
+			}
+			size = std::min(size, max_size);
+		}
+		return sizes;
+	}
+
+	// 写入 / 校验块首尾的标记字节
+	inline void stamp(void* ptr, u64 size, u64 id) {
+		auto p = static_cast<byte*>(ptr);
+		p[0] = static_cast<byte>(id);
+		p[size - 1] = static_cast<byte>(id >> 8);
+	}
+
+	inline bool verify(void* ptr, u64 size, u64 id) {
+		auto p = static_cast<byte*>(ptr);
+		return p[0] == static_cast<byte>(id) && p[size - 1] == static_cast<byte>(id >> 8);
+	}
+
+	u64 percentile(std::vector<u64>& samples, f64 p) {
+		if (samples.empty()) {
+			return 0;
+		}
+		size_t index = std::min(samples.size() - 1, static_cast<size_t>(p * (samples.size() - 1)));
+		std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+		return samples[index];
+	}
+
+	void finish(case_result& result, std::vector<u64>& latencies, rss_sampler& sampler, tools::time::clock::time_point begin) {
+		auto end = tools::time::clock::now();
+		result.seconds = std::chrono::duration_cast<tools::time::seconds>(end - begin).count();
+		result.throughput = result.seconds > 0 ? result.operations / result.seconds : 0;
+		result.p50_ns = percentile(latencies, 0.50);
+		result.p99_ns = percentile(latencies, 0.99);
+		result.p999_ns = percentile(latencies, 0.999);
+		result.rss_samples = sampler.stop();
+		for (auto& sample : result.rss_samples) {
+			result.rss_peak = std::max(result.rss_peak, sample.second);
+		}
+		result.rss_end = result.rss_samples.back().second;
+	}
+
+	// 持续替换：保持 window 个存活对象，每次随机释放一个并分配一个新的
+	template <typename Adapter>
+	case_result run_churn(const std::string& distribution, u64 operations, u64 window) {
+		Adapter adapter;
+		case_result result;
+		result.allocator = Adapter::name;
+		result.pattern = "churn_" + distribution;
+
+		auto sizes = make_sizes(distribution, operations + window, Adapter::max_size, 1);
+		std::mt19937_64 rng(2);
+		std::vector<u64> victims(operations);
+		for (auto& victim : victims) {
+			victim = rng() % window;
+		}
+		std::vector<void*> live(window);
+		std::vector<u64> live_id(window);
+		std::vector<u64> latencies;
+		latencies.reserve(operations / latency_stride + 1);
+
+		result.rss_begin = current_rss();
+		rss_sampler sampler;
+		auto begin = tools::time::clock::now();
+		for (u64 i = 0; i < window; ++i) {
+			live[i] = adapter.allocate(sizes[i]);
+			live_id[i] = i;
+			stamp(live[i], sizes[i], i);
+		}
+		for (u64 i = 0; i < operations; ++i) {
+			u64 slot = victims[i];
+			u64 id = window + i;
+			bool timed = i % latency_stride == 0;
+			auto op_begin = timed ? tools::time::clock::now() : tools::time::clock::time_point();
+
+			result.correct = result.correct && verify(live[slot], sizes[live_id[slot]], live_id[slot]);
+			adapter.deallocate(live[slot], sizes[live_id[slot]]);
+			live[slot] = adapter.allocate(sizes[id]);
+
+			if (timed) {
+				latencies.push_back(static_cast<u64>(std::chrono::duration_cast<tools::time::seconds_nano>(tools::time::clock::now() - op_begin).count()));
+			}
+			live_id[slot] = id;
+			stamp(live[slot], sizes[id], id);
+		}
+		for (u64 i = 0; i < window; ++i) {
+			result.correct = result.correct && verify(live[i], sizes[live_id[i]], live_id[i]);
+			adapter.deallocate(live[i], sizes[live_id[i]]);
+		}
+		adapter.round_end();
+		result.operations = (operations + window) * 2;
+		finish(result, latencies, sampler, begin);
+		return result;
+	}
+
+	// 批量：每轮分配 batch 个混合尺寸对象，再按随机顺序全部释放
+	template <typename Adapter>
+	case_result run_batch(u64 operations, u64 batch) {
+		Adapter adapter;
+		case_result result;
+		result.allocator = Adapter::name;
+		result.pattern = "batch_mixed";
+
+		auto sizes = make_sizes("mixed", batch, Adapter::max_size, 3);
+		std::vector<u64> order(batch);
+		for (u64 i = 0; i < batch; ++i) {
+			order[i] = i;
+		}
+		std::shuffle(order.begin(), order.end(), std::mt19937_64(4));
+		std::vector<void*> ptrs(batch);
+		std::vector<u64> latencies;
+		u64 rounds = std::max<u64>(1, operations / batch);
+		latencies.reserve(rounds * batch / latency_stride + 1);
+
+		result.rss_begin = current_rss();
+		rss_sampler sampler;
+		auto begin = tools::time::clock::now();
+		for (u64 round = 0; round < rounds; ++round) {
+			for (u64 i = 0; i < batch; ++i) {
+				bool timed = i % latency_stride == 0;
+				auto op_begin = timed ? tools::time::clock::now() : tools::time::clock::time_point();
+				ptrs[i] = adapter.allocate(sizes[i]);
+				if (timed) {
+					latencies.push_back(static_cast<u64>(std::chrono::duration_cast<tools::time::seconds_nano>(tools::time::clock::now() - op_begin).count()));
+				}
+				stamp(ptrs[i], sizes[i], i + round);
+			}
+			for (u64 i : order) {
+				result.correct = result.correct && verify(ptrs[i], sizes[i], i + round);
+				adapter.deallocate(ptrs[i], sizes[i]);
+			}
+			adapter.round_end();
+		}
+		result.operations = rounds * batch * 2;
+		finish(result, latencies, sampler, begin);
+		return result;
+	}
+
+	// 生产者 / 消费者：生产者分配并成批交给消费者释放，释放总是发生在其他线程
+	template <typename Adapter>
+	case_result run_producer_consumer(u64 operations, u32 pairs) {
+		Adapter adapter;
+		case_result result;
+		result.allocator = Adapter::name;
+		result.pattern = "producer_consumer";
+		result.threads = pairs * 2;
+
+		constexpr u64 batch = 256;
+		auto sizes = make_sizes("mixed", batch, Adapter::max_size, 5);
+		u64 batches_per_producer = std::max<u64>(1, operations / batch / pairs);
+
+		std::mutex queue_mutex;
+		std::condition_variable queue_cv;
+		std::deque<std::vector<void*>> queue;
+		u32 producers_done = 0;
+		std::atomic<bool> correct{ true };
+		std::vector<std::vector<u64>> latencies(result.threads);
+
+		result.rss_begin = current_rss();
+		rss_sampler sampler;
+		auto begin = tools::time::clock::now();
+		std::vector<std::thread> threads;
+		for (u32 p = 0; p < pairs; ++p) {
+			threads.emplace_back([&, p]() {
+				auto& samples = latencies[p];
+				for (u64 b = 0; b < batches_per_producer; ++b) {
+					std::vector<void*> ptrs(batch);
+					for (u64 i = 0; i < batch; ++i) {
+						bool timed = i % latency_stride == 0;
+						auto op_begin = timed ? tools::time::clock::now() : tools::time::clock::time_point();
+						ptrs[i] = adapter.allocate(sizes[i]);
+						if (timed) {
+							samples.push_back(static_cast<u64>(std::chrono::duration_cast<tools::time::seconds_nano>(tools::time::clock::now() - op_begin).count()));
+						}
+						stamp(ptrs[i], sizes[i], i);
+					}
+					{
+						std::lock_guard<std::mutex> guard(queue_mutex);
+						queue.push_back(std::move(ptrs));
+					}
+					queue_cv.notify_one();
+				}
+				{
+					std::lock_guard<std::mutex> guard(queue_mutex);
+					++producers_done;
+				}
+				queue_cv.notify_all();
+				});
+		}
+		for (u32 c = 0; c < pairs; ++c) {
+			threads.emplace_back([&, c]() {
+				auto& samples = latencies[pairs + c];
+				while (true) {
+					std::vector<void*> ptrs;
+					{
+						std::unique_lock<std::mutex> guard(queue_mutex);
+						queue_cv.wait(guard, [&]() { return !queue.empty() || producers_done == pairs; });
+						if (queue.empty()) {
+							break;
+						}
+						ptrs = std::move(queue.front());
+						queue.pop_front();
+					}
+					for (u64 i = 0; i < ptrs.size(); ++i) {
+						if (!verify(ptrs[i], sizes[i], i)) {
+							correct.store(false);
+						}
+						bool timed = i % latency_stride == 0;
+						auto op_begin = timed ? tools::time::clock::now() : tools::time::clock::time_point();
+						adapter.deallocate(ptrs[i], sizes[i]);
+						if (timed) {
+							samples.push_back(static_cast<u64>(std::chrono::duration_cast<tools::time::seconds_nano>(tools::time::clock::now() - op_begin).count()));
+						}
+					}
+				}
+				});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		std::vector<u64> all;
+		for (auto& samples : latencies) {
+			all.insert(all.end(), samples.begin(), samples.end());
+		}
+		result.correct = correct.load();
+		result.operations = batches_per_producer * pairs * batch * 2;
+		finish(result, all, sampler, begin);
+		return result;
+	}
+
+	template <typename Adapter>
+	void run_all(std::vector<case_result>& results, u64 operations, u32 pairs) {
+		if constexpr (Adapter::individual_free && Adapter::max_size >= 64) {
+			results.push_back(run_churn<Adapter>("fixed64", operations, 4096));
+		}
+		if constexpr (Adapter::individual_free && Adapter::max_size == ~0ull) {
+			results.push_back(run_churn<Adapter>("mixed", operations, 4096));
+		}
+		if constexpr (Adapter::max_size == ~0ull) {
+			results.push_back(run_batch<Adapter>(operations, 10000));
+		}
+		if constexpr (Adapter::thread_safe) {
+			results.push_back(run_producer_consumer<Adapter>(operations, pairs));
+		}
+	}
+
+	void write_json(const std::string& path, const std::vector<case_result>& results) {
+		std::ofstream file(path, std::ios::out | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("无法打开文件用于写入: " + path);
+		}
+		file << "{\n  \"results\": [\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const auto& r = results[i];
+			file << "    {\"allocator\": \"" << r.allocator << "\""
+				<< ", \"pattern\": \"" << r.pattern << "\""
+				<< ", \"threads\": " << r.threads
+				<< ", \"operations\": " << r.operations
+				<< ", \"seconds\": " << r.seconds
+				<< ", \"throughput\": " << r.throughput
+				<< ", \"p50_ns\": " << r.p50_ns
+				<< ", \"p99_ns\": " << r.p99_ns
+				<< ", \"p999_ns\": " << r.p999_ns
+				<< ", \"rss_begin\": " << r.rss_begin
+				<< ", \"rss_peak\": " << r.rss_peak
+				<< ", \"rss_end\": " << r.rss_end
+				<< ", \"rss_samples\": [";
+			for (size_t s = 0; s < r.rss_samples.size(); ++s) {
+				file << (s ? ", " : "") << "[" << r.rss_samples[s].first << ", " << r.rss_samples[s].second << "]";
+			}
+			file << "], \"correct\": " << (r.correct ? "true" : "false")
+				<< "}" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		file << "  ]\n}\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string output_path = "allocator_benchmark.json";
+	u64 operations = 2'000'000;
+	bool quick = false;
+	std::vector<std::string> positional;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--quick") {
+			quick = true;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+	if (positional.size() > 0) {
+		output_path = positional[0];
+	}
+	if (positional.size() > 1) {
+		operations = std::stoull(positional[1]);
+	}
+	if (quick && positional.size() < 2) {
+		operations = 50'000;
+	}
+
+	u32 pairs = std::max(1u, std::thread::hardware_concurrency() / 2);
+	std::vector<case_result> results;
+	run_all<malloc_adapter>(results, operations, pairs);
+	run_all<new_adapter>(results, operations, pairs);
+	run_all<system_adapter>(results, operations, pairs);
+	run_all<arena_adapter>(results, operations, pairs);
+	run_all<pool_adapter>(results, operations, pairs);
+	run_all<caching_adapter>(results, operations, pairs);
+	run_all<buddy_adapter>(results, operations, pairs);
+
+	bool all_correct = true;
+	std::printf("%-18s %-18s %7s %14s %9s %9s %9s %10s %10s %s\n",
+		"allocator", "pattern", "threads", "ops/s", "p50(ns)", "p99(ns)", "p999(ns)", "rss+(KiB)", "peak(KiB)", "ok");
+	for (const auto& r : results) {
+		std::printf("%-18s %-18s %7u %14.0f %9llu %9llu %9llu %10lld %10llu %s\n",
+			r.allocator.c_str(), r.pattern.c_str(), r.threads, r.throughput,
+			static_cast<unsigned long long>(r.p50_ns), static_cast<unsigned long long>(r.p99_ns),
+			static_cast<unsigned long long>(r.p999_ns),
+			static_cast<long long>(r.rss_end - r.rss_begin) / 1024, static_cast<unsigned long long>(r.rss_peak / 1024),
+			r.correct ? "yes" : "NO");
+		all_correct = all_correct && r.correct;
+	}
+
+	write_json(output_path, results);
+	std::printf("results written to %s\n", output_path.c_str());
+	return all_correct ? 0 : 1;
+}
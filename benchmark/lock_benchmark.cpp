@@ -0,0 +1,247 @@
+// lock_benchmark.cpp
+// 对比各自旋锁在不同线程数、临界区长度和超额订阅比例下的吞吐量、公平性与获取延迟，
+// 同时校验互斥性（临界区内的非原子计数不能丢失更新）。
+//
+// 用法: lock_benchmark [输出 JSON 路径] [每组测试毫秒数] [--quick]
+// 互斥性校验失败时返回非 0。
+#include "../tools.hpp"
+#include "../append/threaded_data_container.hpp"
+#include "../append/time.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+
+namespace {
+	// 标准库互斥量，作为对照
+	struct std_mutex_lock {
+		std::mutex mutex;
+		void lock() { mutex.lock(); }
+		void unlock() { mutex.unlock(); }
+	};
+
+	// 模拟临界区 / 非临界区内的工作量
+	void spin_work(u32 units) {
+		for (u32 i = 0; i < units; ++i) {
+			std::atomic_signal_fence(std::memory_order_seq_cst); // 防止编译器优化掉循环
+		}
+	}
+
+	struct case_config {
+		u32 threads;
+		u32 critical_units;
+		u32 outside_units;
+		f64 oversubscription;
+	};
+
+	struct case_result {
+		std::string lock_name;
+		case_config config;
+		u64 total_acquisitions = 0;
+		f64 seconds = 0;
+		f64 throughput = 0;			// 每秒获取次数
+		u64 min_per_thread = 0;
+		u64 max_per_thread = 0;
+		f64 fairness_cv = 0;		// 每线程获取次数的变异系数，越小越公平
+		u64 p50_ns = 0;
+		u64 p99_ns = 0;
+		u64 p999_ns = 0;
+		bool correct = true;
+	};
+
+	// 每个线程最多记录的延迟样本数
+	constexpr size_t max_samples_per_thread = 1 << 16;
+
+	template <typename Lock>
+	case_result run_case(const std::string& name, const case_config& config, tools::time::seconds_nano duration) {
+		Lock lock;
+		u64 shared_counter = 0; // 仅在临界区内修改
+		std::atomic<bool> start{ false };
+		std::atomic<bool> stop{ false };
+		std::atomic<u32> ready{ 0 };
+
+		std::vector<u64> acquisitions(config.threads, 0);
+		std::vector<std::vector<u64>> latencies(config.threads);
+		std::vector<std::thread> threads;
+		threads.reserve(config.threads);
+
+		for (u32 t = 0; t < config.threads; ++t) {
+			threads.emplace_back([&, t]() {
+				auto& samples = latencies[t];
+				samples.reserve(max_samples_per_thread);
+				u64 count = 0;
+				ready.fetch_add(1);
+				while (!start.load(std::memory_order_acquire)) {
+					std::this_thread::yield();
+				}
+				while (!stop.load(std::memory_order_relaxed)) {
+					auto begin = tools::time::clock::now();
+					lock.lock();
+					auto acquired = tools::time::clock::now();
+					shared_counter = shared_counter + 1;
+					spin_work(config.critical_units);
+					lock.unlock();
+
+					if (samples.size() < max_samples_per_thread) {
+						samples.push_back(static_cast<u64>(std::chrono::duration_cast<tools::time::seconds_nano>(acquired - begin).count()));
+					}
+					++count;
+					spin_work(config.outside_units);
+				}
+				acquisitions[t] = count;
+				});
+		}
+
+		while (ready.load() < config.threads) {
+			std::this_thread::yield();
+		}
+		auto begin = tools::time::clock::now();
+		start.store(true, std::memory_order_release);
+		tools::time::sleep_for(duration);
+		stop.store(true);
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		auto end = tools::time::clock::now();
+
+		case_result result;
+		result.lock_name = name;
+		result.config = config;
+		result.seconds = std::chrono::duration_cast<tools::time::seconds>(end - begin).count();
+
+		f64 mean = 0;
+		result.min_per_thread = std::numeric_limits<u64>::max();
+		for (auto count : acquisitions) {
+			result.total_acquisitions += count;
+			result.min_per_thread = std::min(result.min_per_thread, count);
+			result.max_per_thread = std::max(result.max_per_thread, count);
+		}
+		mean = static_cast<f64>(result.total_acquisitions) / config.threads;
+		f64 variance = 0;
+		for (auto count : acquisitions) {
+			variance += (count - mean) * (count - mean);
+		}
+		variance /= config.threads;
+		result.fairness_cv = mean > 0 ? std::sqrt(variance) / mean : 0;
+		result.throughput = result.seconds > 0 ? result.total_acquisitions / result.seconds : 0;
+		result.correct = shared_counter == result.total_acquisitions;
+
+		std::vector<u64> all;
+		for (auto& samples : latencies) {
+			all.insert(all.end(), samples.begin(), samples.end());
+		}
+		auto percentile = [&all](f64 p) -> u64 {
+			if (all.empty()) {
+				return 0;
+			}
+			size_t index = std::min(all.size() - 1, static_cast<size_t>(p * (all.size() - 1)));
+			std::nth_element(all.begin(), all.begin() + index, all.end());
+			return all[index];
+			};
+		result.p50_ns = percentile(0.50);
+		result.p99_ns = percentile(0.99);
+		result.p999_ns = percentile(0.999);
+		return result;
+	}
+
+	void write_json(const std::string& path, const std::vector<case_result>& results, u32 hardware_threads) {
+		std::ofstream file(path, std::ios::out | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("无法打开文件用于写入: " + path);
+		}
+		file << "{\n  \"hardware_threads\": " << hardware_threads << ",\n  \"results\": [\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const auto& r = results[i];
+			file << "    {\"lock\": \"" << r.lock_name << "\""
+				<< ", \"threads\": " << r.config.threads
+				<< ", \"oversubscription\": " << r.config.oversubscription
+				<< ", \"critical_units\": " << r.config.critical_units
+				<< ", \"outside_units\": " << r.config.outside_units
+				<< ", \"acquisitions\": " << r.total_acquisitions
+				<< ", \"seconds\": " << r.seconds
+				<< ", \"throughput\": " << r.throughput
+				<< ", \"min_per_thread\": " << r.min_per_thread
+				<< ", \"max_per_thread\": " << r.max_per_thread
+				<< ", \"fairness_cv\": " << r.fairness_cv
+				<< ", \"p50_ns\": " << r.p50_ns
+				<< ", \"p99_ns\": " << r.p99_ns
+				<< ", \"p999_ns\": " << r.p999_ns
+				<< ", \"correct\": " << (r.correct ? "true" : "false")
+				<< "}" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		file << "  ]\n}\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string output_path = "lock_benchmark.json";
+	u64 duration_ms = 200;
+	bool quick = false;
+	std::vector<std::string> positional;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--quick") {
+			quick = true;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+	if (positional.size() > 0) {
+		output_path = positional[0];
+	}
+	if (positional.size() > 1) {
+		duration_ms = std::stoull(positional[1]);
+	}
+	if (quick && positional.size() < 2) {
+		duration_ms = 20;
+	}
+
+	u32 hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	// 线程数：1、2、4 以及硬件线程数的 1/2/4 倍（超额订阅）
+	std::vector<std::pair<u32, f64>> thread_counts;
+	for (u32 t : { 1u, 2u, 4u }) {
+		if (t < hardware_threads) {
+			thread_counts.push_back({ t, static_cast<f64>(t) / hardware_threads });
+		}
+	}
+	for (u32 ratio : { 1u, 2u, 4u }) {
+		if (quick && ratio > 2) {
+			break;
+		}
+		thread_counts.push_back({ hardware_threads * ratio, static_cast<f64>(ratio) });
+	}
+	std::vector<u32> critical_lengths = quick ? std::vector<u32>{ 0, 100 } : std::vector<u32>{ 0, 50, 500, 5000 };
+	u32 outside_units = 100;
+
+	auto duration = tools::time::seconds_nano(duration_ms * 1'000'000);
+	std::vector<case_result> results;
+	for (auto& thread_count : thread_counts) {
+		for (u32 critical : critical_lengths) {
+			case_config config{ thread_count.first, critical, outside_units, thread_count.second };
+			results.push_back(run_case<tools::threaded_data_container::spin_lock>("spin_lock", config, duration));
+			results.push_back(run_case<tools::threaded_data_container::ticket_lock>("ticket_lock", config, duration));
+			results.push_back(run_case<tools::threaded_data_container::mcs_lock>("mcs_lock", config, duration));
+			results.push_back(run_case<tools::data_container::atomic_apin_lock>("atomic_apin_lock", config, duration));
+			results.push_back(run_case<std_mutex_lock>("std_mutex", config, duration));
+		}
+	}
+
+	bool all_correct = true;
+	std::printf("%-18s %8s %6s %8s %14s %8s %10s %10s %10s %s\n",
+		"lock", "threads", "over", "critical", "acq/s", "cv", "p50(ns)", "p99(ns)", "p999(ns)", "ok");
+	for (const auto& r : results) {
+		std::printf("%-18s %8u %6.2f %8u %14.0f %8.3f %10llu %10llu %10llu %s\n",
+			r.lock_name.c_str(), r.config.threads, r.config.oversubscription, r.config.critical_units,
+			r.throughput, r.fairness_cv,
+			static_cast<unsigned long long>(r.p50_ns), static_cast<unsigned long long>(r.p99_ns),
+			static_cast<unsigned long long>(r.p999_ns), r.correct ? "yes" : "NO");
+		all_correct = all_correct && r.correct;
+	}
+
+	write_json(output_path, results, hardware_threads);
+	std::printf("results written to %s\n", output_path.c_str());
+	return all_correct ? 0 : 1;
+}
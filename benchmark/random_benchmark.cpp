@@ -0,0 +1,298 @@
+// random_benchmark.cpp
+// 测量 random 模块中 safe_random 与各引擎在 1 到 N 个线程下的吞吐量（每个 u64 的纳秒数），
+// 以及批量填充接口的带宽（GB/s）；同时对每个来源的输出做卡方、位频率与序列相关的冒烟检验，
+// 防止性能优化悄悄破坏输出质量。
+//
+// 用法: random_benchmark [输出 JSON 路径] [每线程生成的 u64 个数] [--quick]
+// 先运行 tools::test::random_test()（已知答案向量、SIMD 与标量实现一致性等），
+// 其失败或任一来源的质量检验失败时返回非 0。
+#include "../tools.hpp"
+#include "../append/random.hpp"
+#include "../append/time.hpp"
+
+#include <algorithm>
+#include <random>
+
+
+namespace {
+	using namespace tools::random;
+
+	// 防止生成结果被优化掉
+	std::atomic<u64> sink{ 0 };
+
+	// 第 index 个线程的引擎，可跳跃的引擎按线程 jump() 得到互不重叠的流
+	struct safe_random_source {
+		static constexpr const char* name = "safe_random";
+		static auto make(u32) {
+			return []() { return safe_random(); };
+		}
+	};
+
+	struct chacha20_source {
+		static constexpr const char* name = "chacha20_csprng";
+		static auto make(u32) {
+			return []() { return chacha20_csprng::local()(); };
+		}
+	};
+
+	template <typename Engine>
+	struct jump_source {
+		static auto make(u32 index) {
+			Engine engine(12345);
+			for (u32 i = 0; i < index; ++i) {
+				engine.jump();
+			}
+			return engine;
+		}
+	};
+
+	struct xoshiro_source : jump_source<xoshiro256ss> {
+		static constexpr const char* name = "xoshiro256ss";
+	};
+
+	struct pcg_source : jump_source<pcg64> {
+		static constexpr const char* name = "pcg64";
+	};
+
+	struct wyrand_source : jump_source<wyrand> {
+		static constexpr const char* name = "wyrand";
+	};
+
+	struct philox_source {
+		static constexpr const char* name = "philox4x32";
+		static auto make(u32 index) {
+			return philox4x32(12345, index);
+		}
+	};
+
+	struct mt19937_source {
+		static constexpr const char* name = "std::mt19937_64";
+		static auto make(u32 index) {
+			return std::mt19937_64(12345 + index);
+		}
+	};
+
+	struct case_result {
+		std::string source;
+		std::string mode;			// "engine" 为逐个调用，"fill" 为批量填充
+		u32 threads = 0;
+		u64 values = 0;				// 所有线程生成的 u64 总数
+		f64 seconds = 0;
+		f64 ns_per_value = 0;		// 单个线程生成一个 u64 的平均耗时
+		f64 gigabytes_per_second = 0;	// 所有线程合计
+		quality_report quality;
+	};
+
+	// threads 个线程同时开始，各自执行 work(index)，返回从开始到全部结束的秒数
+	template <typename Work>
+	f64 run_threads(u32 threads, Work&& work) {
+		std::atomic<u32> ready{ 0 };
+		std::atomic<bool> start{ false };
+		std::vector<std::thread> workers;
+		for (u32 t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t]() {
+				ready.fetch_add(1);
+				while (!start.load(std::memory_order_acquire)) {
+					std::this_thread::yield();
+				}
+				work(t);
+				});
+		}
+		while (ready.load() < threads) {
+			std::this_thread::yield();
+		}
+		auto begin = tools::time::clock::now();
+		start.store(true, std::memory_order_release);
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		return std::chrono::duration_cast<tools::time::seconds>(tools::time::clock::now() - begin).count();
+	}
+
+	void finish(case_result& result, u64 values_per_thread) {
+		result.values = values_per_thread * result.threads;
+		result.ns_per_value = result.seconds * 1e9 * result.threads / static_cast<f64>(result.values);
+		result.gigabytes_per_second = static_cast<f64>(result.values) * sizeof(u64) / result.seconds / 1e9;
+	}
+
+	// 逐个调用 operator()，质量检验取第 0 个线程的前 quality_samples 个值
+	template <typename Source>
+	case_result run_engine(u32 threads, u64 values_per_thread, size_t quality_samples) {
+		case_result result;
+		result.source = Source::name;
+		result.mode = "engine";
+		result.threads = threads;
+
+		std::vector<u64> samples(quality_samples);
+		result.seconds = run_threads(threads, [&](u32 index) {
+			auto engine = Source::make(index);
+			u64 local_sum = 0;
+			for (u64 i = 0; i < values_per_thread; ++i) {
+				u64 value = engine();
+				if (index == 0 && i < samples.size()) {
+					samples[i] = value;
+				}
+				local_sum += value;
+			}
+			sink.fetch_add(local_sum, std::memory_order_relaxed);
+			});
+		finish(result, values_per_thread);
+		result.quality = check_quality(std::span<const u64>(samples.data(), std::min<size_t>(samples.size(), values_per_thread)));
+		return result;
+	}
+
+	// 以 64 KiB 的块反复批量填充，fill(index, buffer, offset) 负责生成
+	template <typename Fill>
+	case_result run_fill(const char* name, u32 threads, u64 values_per_thread, Fill&& fill) {
+		constexpr size_t chunk_values = 8192;
+		case_result result;
+		result.source = name;
+		result.mode = "fill";
+		result.threads = threads;
+
+		std::vector<std::vector<u64>> buffers(threads, std::vector<u64>(chunk_values));
+		result.seconds = run_threads(threads, [&](u32 index) {
+			auto& buffer = buffers[index];
+			u64 local_sum = 0;
+			for (u64 done = 0; done < values_per_thread; done += chunk_values) {
+				fill(index, std::span<u64>(buffer), done);
+				local_sum += buffer[done % chunk_values];
+			}
+			sink.fetch_add(local_sum, std::memory_order_relaxed);
+			});
+		u64 chunks = (values_per_thread + chunk_values - 1) / chunk_values;
+		finish(result, chunks * chunk_values);
+		result.quality = check_quality(buffers[0]);
+		return result;
+	}
+
+	void run_all(std::vector<case_result>& results, const std::vector<u32>& thread_counts, u64 values_per_thread, size_t quality_samples) {
+		for (u32 threads : thread_counts) {
+			results.push_back(run_engine<safe_random_source>(threads, values_per_thread, quality_samples));
+			results.push_back(run_engine<chacha20_source>(threads, values_per_thread, quality_samples));
+			results.push_back(run_engine<xoshiro_source>(threads, values_per_thread, quality_samples));
+			results.push_back(run_engine<pcg_source>(threads, values_per_thread, quality_samples));
+			results.push_back(run_engine<wyrand_source>(threads, values_per_thread, quality_samples));
+			results.push_back(run_engine<philox_source>(threads, values_per_thread, quality_samples));
+			results.push_back(run_engine<mt19937_source>(threads, values_per_thread, quality_samples));
+
+			std::vector<bulk_random> bulks;
+			xoshiro256ss base(12345);
+			for (u32 t = 0; t < threads; ++t) {
+				bulks.emplace_back(base);
+				base.long_jump();
+			}
+			results.push_back(run_fill("bulk_random", threads, values_per_thread, [&bulks](u32 index, std::span<u64> out, u64) {
+				bulks[index].fill(out);
+				}));
+			results.push_back(run_fill("philox4x32::generate", threads, values_per_thread, [](u32 index, std::span<u64> out, u64 offset) {
+				philox4x32(12345, index).generate(offset, out);
+				}));
+			results.push_back(run_fill("secure_fill", threads, values_per_thread, [](u32, std::span<u64> out, u64) {
+				secure_fill(std::span<byte>(reinterpret_cast<byte*>(out.data()), out.size_bytes()));
+				}));
+		}
+
+		// 线程池上的并行填充：一次填满整个缓冲区，结果与线程数无关
+		case_result parallel;
+		parallel.source = "parallel_fill";
+		parallel.mode = "fill";
+		parallel.threads = tools::thread_pool::default_executor().size();
+		std::vector<u64> buffer(std::max<u64>(values_per_thread, 8192));
+		parallel.seconds = run_threads(1, [&](u32) {
+			parallel_fill(std::span<u64>(buffer), 12345);
+			});
+		parallel.values = buffer.size();
+		parallel.ns_per_value = parallel.seconds * 1e9 * parallel.threads / static_cast<f64>(parallel.values);
+		parallel.gigabytes_per_second = static_cast<f64>(parallel.values) * sizeof(u64) / parallel.seconds / 1e9;
+		parallel.quality = check_quality(std::span<const u64>(buffer.data(), std::min<size_t>(buffer.size(), quality_samples)));
+		results.push_back(parallel);
+	}
+
+	void write_json(const std::string& path, const std::vector<case_result>& results, u32 hardware_threads) {
+		std::ofstream file(path, std::ios::out | std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("无法打开文件用于写入: " + path);
+		}
+		file << "{\n  \"hardware_threads\": " << hardware_threads << ",\n  \"results\": [\n";
+		for (size_t i = 0; i < results.size(); ++i) {
+			const auto& r = results[i];
+			file << "    {\"source\": \"" << r.source << "\""
+				<< ", \"mode\": \"" << r.mode << "\""
+				<< ", \"threads\": " << r.threads
+				<< ", \"values\": " << r.values
+				<< ", \"seconds\": " << r.seconds
+				<< ", \"ns_per_value\": " << r.ns_per_value
+				<< ", \"gigabytes_per_second\": " << r.gigabytes_per_second
+				<< ", \"quality_samples\": " << r.quality.samples
+				<< ", \"chi_squared\": " << r.quality.chi_squared
+				<< ", \"max_bit_bias_z\": " << r.quality.max_bit_bias_z
+				<< ", \"serial_correlation_z\": " << r.quality.serial_correlation_z
+				<< ", \"quality_passed\": " << (r.quality.passed() ? "true" : "false")
+				<< "}" << (i + 1 < results.size() ? "," : "") << "\n";
+		}
+		file << "  ]\n}\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	std::string output_path = "random_benchmark.json";
+	u64 values_per_thread = 20'000'000;
+	bool quick = false;
+	std::vector<std::string> positional;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg == "--quick") {
+			quick = true;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+	if (positional.size() > 0) {
+		output_path = positional[0];
+	}
+	if (positional.size() > 1) {
+		values_per_thread = std::stoull(positional[1]);
+	}
+	if (quick && positional.size() < 2) {
+		values_per_thread = 300'000;
+	}
+	size_t quality_samples = quick ? size_t(1) << 16 : size_t(1) << 20;
+
+#ifdef tools_debug
+	// 正确性检验失败时不再测量性能
+	if (u64 error = tools::test::random_test()) {
+		std::printf("random_test failed: %llx\n", static_cast<unsigned long long>(error));
+		return 1;
+	}
+#endif
+
+	// 线程数：1、2、4 以及硬件线程数
+	u32 hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<u32> thread_counts;
+	for (u32 t : { 1u, 2u, 4u }) {
+		if (t < hardware_threads && !(quick && t > 1)) {
+			thread_counts.push_back(t);
+		}
+	}
+	thread_counts.push_back(hardware_threads);
+
+	std::vector<case_result> results;
+	run_all(results, thread_counts, values_per_thread, quality_samples);
+
+	bool all_passed = true;
+	std::printf("%-22s %-7s %7s %12s %10s %10s %8s %8s %s\n",
+		"source", "mode", "threads", "ns/u64", "GB/s", "chi2", "bit z", "corr z", "ok");
+	for (const auto& r : results) {
+		std::printf("%-22s %-7s %7u %12.3f %10.3f %10.1f %8.2f %8.2f %s\n",
+			r.source.c_str(), r.mode.c_str(), r.threads, r.ns_per_value, r.gigabytes_per_second,
+			r.quality.chi_squared, r.quality.max_bit_bias_z, r.quality.serial_correlation_z,
+			r.quality.passed() ? "yes" : "NO");
+		all_passed = all_passed && r.quality.passed();
+	}
+
+	write_json(output_path, results, hardware_threads);
+	std::printf("results written to %s\n", output_path.c_str());
+	return all_passed ? 0 : 1;
+}
@@ -239,6 +239,165 @@ namespace tools {
 			}
 		}
 
+		/**
+		 * @brief 通过线程池并行加载二进制文件，不创建新线程。
+		 * @param file_path 文件路径。
+		 * @param buffer 输出缓冲区（内存由函数分配，使用 free_buffer 释放）。
+		 * @param size 输出文件大小。
+		 * @param min_chunk_size 最小分块大小（字节），低于此值时只提交 1 个任务。
+		 * @param executor_ 执行分块读取的线程池。
+		 * @return 所有分块读取完成后就绪的 future，读取失败的异常在 get() 时抛出。
+		 * @throws 如果文件不存在或无法打开，则抛出异常。
+		 */
+		thread_pool::future<void> async_load_binary_file(const fs::path& file_path, char*& buffer, size_t& size,
+			std::size_t min_chunk_size, thread_pool::executor& executor_) {
+			if (!fs::exists(file_path) || !fs::is_regular_file(file_path)) {
+				throw std::runtime_error("文件不存在: " + file_path.string());
+			}
+
+			size = static_cast<size_t>(fs::file_size(file_path));
+			buffer = new char[size];  // 自动分配内存
+
+			// 按线程池大小分块，确保每块不小于 min_chunk_size
+			size_t chunk_size = std::max<size_t>(min_chunk_size, parallel::default_grain(size, executor_));
+			size_t chunk_count = std::max<size_t>(1, parallel::chunk_count(size, chunk_size));
+
+			std::vector<thread_pool::future<void>> chunks;
+			chunks.reserve(chunk_count);
+			for (size_t i = 0; i < chunk_count; ++i) {
+				auto chunk = parallel::chunk_range(size, chunk_size, i);
+				chunks.push_back(executor_.submit([file_path, data = buffer, start = chunk.begin, end = chunk.end]() {
+					std::ifstream chunk_file(file_path, std::ios::binary);
+					if (!chunk_file.is_open()) {
+						throw std::runtime_error("无法打开文件: " + file_path.string());
+					}
+
+					chunk_file.seekg(start, std::ios::beg);
+					chunk_file.read(data + start, end - start);
+					}));
+			}
+			return thread_pool::when_all(std::move(chunks), executor_);
+		}
+
+		/**
+		 * @brief 通过线程池并行写入二进制文件，不创建新线程。
+		 * @param file_path 文件路径。
+		 * @param data 要写入的字节数据，future 就绪前必须保持有效。
+		 * @param size 数据大小。
+		 * @param min_chunk_size 最小分块大小（字节），低于此值时只提交 1 个任务。
+		 * @param executor_ 执行分块写入的线程池。
+		 * @return 所有分块写入完成后就绪的 future，写入失败的异常在 get() 时抛出。
+		 * @throws 如果文件无法创建，则抛出异常。
+		 */
+		thread_pool::future<void> async_write_binary_file(const fs::path& file_path, const char* data, size_t size,
+			std::size_t min_chunk_size, thread_pool::executor& executor_) {
+			// 先创建文件并设置大小，各分块以读写模式打开后定位写入
+			{
+				std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+				if (!file.is_open()) {
+					throw std::runtime_error("无法打开文件用于写入: " + file_path.string());
+				}
+			}
+			fs::resize_file(file_path, size);
+
+			size_t chunk_size = std::max<size_t>(min_chunk_size, parallel::default_grain(size, executor_));
+			size_t chunk_count = std::max<size_t>(1, parallel::chunk_count(size, chunk_size));
+
+			std::vector<thread_pool::future<void>> chunks;
+			chunks.reserve(chunk_count);
+			for (size_t i = 0; i < chunk_count; ++i) {
+				auto chunk = parallel::chunk_range(size, chunk_size, i);
+				chunks.push_back(executor_.submit([file_path, data, start = chunk.begin, end = chunk.end]() {
+					std::ofstream chunk_file(file_path, std::ios::binary | std::ios::in | std::ios::out);
+					if (!chunk_file.is_open()) {
+						throw std::runtime_error("无法打开文件用于写入: " + file_path.string());
+					}
+
+					chunk_file.seekp(start, std::ios::beg);
+					chunk_file.write(data + start, end - start);
+					}));
+			}
+			return thread_pool::when_all(std::move(chunks), executor_);
+		}
+
+		/**
+		 * @brief 列出指定路径下的所有文件（非递归），结果向量从 resource 分配。
+		 * @param dir 要扫描的目录路径。
+		 * @param resource 结果向量使用的内存资源。
+		 * @return 包含所有文件路径的向量。
+		 */
+		std::pmr::vector<fs::path> list_files(const fs::path& dir, std::pmr::memory_resource* resource) {
+			std::pmr::vector<fs::path> files(resource);
+			for (const auto& entry : fs::directory_iterator(dir)) {
+				if (entry.is_regular_file()) {
+					files.push_back(entry.path());
+				}
+			}
+			return files;
+		}
+
+		/**
+		 * @brief 递归列出指定路径下的所有文件，结果向量从 resource 分配。
+		 * @param dir 要扫描的目录路径。
+		 * @param resource 结果向量使用的内存资源。
+		 * @return 包含所有文件路径的向量。
+		 */
+		std::pmr::vector<fs::path> list_files_recursive(const fs::path& dir, std::pmr::memory_resource* resource) {
+			std::pmr::vector<fs::path> files(resource);
+			for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+				if (entry.is_regular_file()) {
+					files.push_back(entry.path());
+				}
+			}
+			return files;
+		}
+
+		/**
+		 * @brief 加载文本文件的内容为字符串，字符串从 resource 分配。
+		 * @param file_path 文件路径。
+		 * @param resource 字符串使用的内存资源。
+		 * @return 文件内容。
+		 * @throws 如果文件不存在或无法打开，则抛出异常。
+		 */
+		std::pmr::string load_text_file(const fs::path& file_path, std::pmr::memory_resource* resource) {
+			if (!fs::exists(file_path) || !fs::is_regular_file(file_path)) {
+				throw std::runtime_error("文件不存在: " + file_path.string());
+			}
+
+			std::ifstream file(file_path, std::ios::in);
+			if (!file.is_open()) {
+				throw std::runtime_error("无法打开文件: " + file_path.string());
+			}
+
+			// 按文件大小一次分配，文本模式下实际读到的字节数可能更少
+			std::pmr::string content(resource);
+			content.resize(static_cast<size_t>(fs::file_size(file_path)));
+			file.read(content.data(), content.size());
+			content.resize(static_cast<size_t>(file.gcount()));
+			return content;
+		}
+
+		/**
+		 * @brief 加载二进制文件内容到从 resource 分配的缓冲区。
+		 * @param file_path 文件路径。
+		 * @param resource 缓冲区使用的内存资源。
+		 * @return 文件的字节数据。
+		 * @throws 如果文件不存在或无法打开，则抛出异常。
+		 */
+		std::pmr::vector<char> load_binary_file(const fs::path& file_path, std::pmr::memory_resource* resource) {
+			if (!fs::exists(file_path) || !fs::is_regular_file(file_path)) {
+				throw std::runtime_error("文件不存在: " + file_path.string());
+			}
+
+			std::ifstream file(file_path, std::ios::binary);
+			if (!file.is_open()) {
+				throw std::runtime_error("无法打开文件: " + file_path.string());
+			}
+
+			std::pmr::vector<char> buffer(static_cast<size_t>(fs::file_size(file_path)), resource);
+			file.read(buffer.data(), buffer.size());
+			return buffer;
+		}
 
 	}
 	namespace test {
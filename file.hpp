@@ -1,5 +1,6 @@
 #pragma once
 #include "tools.hpp"
+#include "./append/parallel.hpp"
 
 namespace tools {
 	namespace file {
@@ -103,6 +104,66 @@ namespace tools {
 		inline void async_write_binary_file(const fs::path& file_path, std::vector<std::thread>& threads,
 			const char* data, size_t size, std::size_t min_chunk_size = 1 << 24);
 
+		/**
+		 * @brief 通过线程池并行加载二进制文件，不创建新线程。
+		 * @param file_path 文件路径。
+		 * @param buffer 输出缓冲区（内存由函数分配，使用 free_buffer 释放）。
+		 * @param size 输出文件大小。
+		 * @param min_chunk_size 最小分块大小（字节），低于此值时只提交 1 个任务。
+		 * @param executor_ 执行分块读取的线程池。
+		 * @return 所有分块读取完成后就绪的 future，读取失败的异常在 get() 时抛出。
+		 * @throws 如果文件不存在或无法打开，则抛出异常。
+		 */
+		thread_pool::future<void> async_load_binary_file(const fs::path& file_path, char*& buffer, size_t& size,
+			std::size_t min_chunk_size = 1 << 24, thread_pool::executor& executor_ = thread_pool::default_executor());
+
+		/**
+		 * @brief 通过线程池并行写入二进制文件，不创建新线程。
+		 * @param file_path 文件路径。
+		 * @param data 要写入的字节数据，future 就绪前必须保持有效。
+		 * @param size 数据大小。
+		 * @param min_chunk_size 最小分块大小（字节），低于此值时只提交 1 个任务。
+		 * @param executor_ 执行分块写入的线程池。
+		 * @return 所有分块写入完成后就绪的 future，写入失败的异常在 get() 时抛出。
+		 * @throws 如果文件无法创建，则抛出异常。
+		 */
+		thread_pool::future<void> async_write_binary_file(const fs::path& file_path, const char* data, size_t size,
+			std::size_t min_chunk_size = 1 << 24, thread_pool::executor& executor_ = thread_pool::default_executor());
+
+		/**
+		 * @brief 列出指定路径下的所有文件（非递归），结果向量从 resource 分配。
+		 * @param dir 要扫描的目录路径。
+		 * @param resource 结果向量使用的内存资源。
+		 * @return 包含所有文件路径的向量。
+		 */
+		std::pmr::vector<fs::path> list_files(const fs::path& dir, std::pmr::memory_resource* resource);
+
+		/**
+		 * @brief 递归列出指定路径下的所有文件，结果向量从 resource 分配。
+		 * @param dir 要扫描的目录路径。
+		 * @param resource 结果向量使用的内存资源。
+		 * @return 包含所有文件路径的向量。
+		 */
+		std::pmr::vector<fs::path> list_files_recursive(const fs::path& dir, std::pmr::memory_resource* resource);
+
+		/**
+		 * @brief 加载文本文件的内容为字符串，字符串从 resource 分配。
+		 * @param file_path 文件路径。
+		 * @param resource 字符串使用的内存资源。
+		 * @return 文件内容。
+		 * @throws 如果文件不存在或无法打开，则抛出异常。
+		 */
+		std::pmr::string load_text_file(const fs::path& file_path, std::pmr::memory_resource* resource);
+
+		/**
+		 * @brief 加载二进制文件内容到从 resource 分配的缓冲区。
+		 * @param file_path 文件路径。
+		 * @param resource 缓冲区使用的内存资源。
+		 * @return 文件的字节数据。
+		 * @throws 如果文件不存在或无法打开，则抛出异常。
+		 */
+		std::pmr::vector<char> load_binary_file(const fs::path& file_path, std::pmr::memory_resource* resource);
+
 	}
 
 	namespace test {
@@ -23,9 +23,11 @@ namespace tools
 
 	namespace string
 	{
-		std::u16string utf8_to_utf16(const std::string &utf8_str)
+		// 以下 *_impl 对输出容器类型泛化，输出容器由调用方以所需的分配器构造后传入，
+		// 使 std 版本与 pmr 版本共用同一份代码
+		template <typename String>
+		String utf8_to_utf16_impl(std::string_view utf8_str, String utf16_str)
 		{
-			std::u16string utf16_str;
 			size_t i = 0;
 			while (i < utf8_str.size())
 			{
@@ -73,9 +75,17 @@ namespace tools
 			}
 			return utf16_str;
 		}
-		std::string utf16_to_utf8(const std::u16string &utf16_str)
+		std::u16string utf8_to_utf16(const std::string &utf8_str)
+		{
+			return utf8_to_utf16_impl(utf8_str, std::u16string());
+		}
+		std::pmr::u16string utf8_to_utf16(std::string_view utf8_str, std::pmr::memory_resource *resource)
+		{
+			return utf8_to_utf16_impl(utf8_str, std::pmr::u16string(resource));
+		}
+		template <typename String>
+		String utf16_to_utf8_impl(std::u16string_view utf16_str, String utf8_str)
 		{
-			std::string utf8_str;
 			for (size_t i = 0; i < utf16_str.size(); ++i)
 			{
 				char16_t c = utf16_str[i];
@@ -117,9 +127,17 @@ namespace tools
 			}
 			return utf8_str;
 		}
-		std::u32string utf8_to_utf32(const std::string &utf8_str)
+		std::string utf16_to_utf8(const std::u16string &utf16_str)
+		{
+			return utf16_to_utf8_impl(utf16_str, std::string());
+		}
+		std::pmr::string utf16_to_utf8(std::u16string_view utf16_str, std::pmr::memory_resource *resource)
+		{
+			return utf16_to_utf8_impl(utf16_str, std::pmr::string(resource));
+		}
+		template <typename String>
+		String utf8_to_utf32_impl(std::string_view utf8_str, String utf32_str)
 		{
-			std::u32string utf32_str;
 			size_t i = 0;
 			while (i < utf8_str.size())
 			{
@@ -166,9 +184,17 @@ namespace tools
 			}
 			return utf32_str;
 		}
-		std::string utf32_to_utf8(const std::u32string &utf32_str)
+		std::u32string utf8_to_utf32(const std::string &utf8_str)
+		{
+			return utf8_to_utf32_impl(utf8_str, std::u32string());
+		}
+		std::pmr::u32string utf8_to_utf32(std::string_view utf8_str, std::pmr::memory_resource *resource)
+		{
+			return utf8_to_utf32_impl(utf8_str, std::pmr::u32string(resource));
+		}
+		template <typename String>
+		String utf32_to_utf8_impl(std::u32string_view utf32_str, String utf8_str)
 		{
-			std::string utf8_str;
 			for (size_t i = 0; i < utf32_str.size(); ++i)
 			{
 				uint32_t c = utf32_str[i];
@@ -202,6 +228,14 @@ namespace tools
 			}
 			return utf8_str;
 		}
+		std::string utf32_to_utf8(const std::u32string &utf32_str)
+		{
+			return utf32_to_utf8_impl(utf32_str, std::string());
+		}
+		std::pmr::string utf32_to_utf8(std::u32string_view utf32_str, std::pmr::memory_resource *resource)
+		{
+			return utf32_to_utf8_impl(utf32_str, std::pmr::string(resource));
+		}
 
 		std::wstring utf8_to_wchar(const std::string &utf8_str)
 		{
@@ -299,10 +333,14 @@ namespace tools
 		}
 
 		// 连续特殊字符过滤器  input:目标字符串 special_string:过滤字符字符串 replacement:替换目标字符串
-		std::u32string filter_consecutive_special_string(const std::u32string &input, const std::vector<std::u32string> &special_strings, const std::u32string &replacement)
+		template <typename String, typename Strings>
+		String filter_consecutive_special_string_impl(std::u32string_view input, const Strings &special_strings, std::u32string_view replacement, String output)
 		{
-			std::u32string output;
-			std::map<size_t, std::vector<std::u32string>> length_map;
+			// 内部容器沿用输出字符串的分配器
+			using allocator_t = std::allocator_traits<typename String::allocator_type>;
+			using views_t = std::vector<std::u32string_view, typename allocator_t::template rebind_alloc<std::u32string_view>>;
+			using map_t = std::map<size_t, views_t, std::less<size_t>, typename allocator_t::template rebind_alloc<std::pair<const size_t, views_t>>>;
+			map_t length_map(output.get_allocator());
 
 			// 将特殊字符串按长度分类存储
 			for (const auto &str : special_strings)
@@ -323,7 +361,7 @@ namespace tools
 					if (i + len > input.size())
 						continue; // 防止越界
 
-					std::u32string substring = input.substr(i, len);
+					std::u32string_view substring = input.substr(i, len);
 
 					// 遍历当前长度的所有特殊字符串，看看是否匹配
 					for (const auto &special : pair.second)
@@ -351,24 +389,29 @@ namespace tools
 
 			return output;
 		}
+		std::u32string filter_consecutive_special_string(const std::u32string &input, const std::vector<std::u32string> &special_strings, const std::u32string &replacement)
+		{
+			return filter_consecutive_special_string_impl(input, special_strings, replacement, std::u32string());
+		}
+		std::pmr::u32string filter_consecutive_special_string(std::u32string_view input, const std::pmr::vector<std::pmr::u32string> &special_strings, std::u32string_view replacement, std::pmr::memory_resource *resource)
+		{
+			return filter_consecutive_special_string_impl(input, special_strings, replacement, std::pmr::u32string(resource));
+		}
 
 		// 连续特殊字符过滤器  input:目标字符串 special_chars:过滤字符 replacement:替换目标字符串
-		std::u32string filter_consecutive_special_chars(const std::u32string &input, const std::u32string &special_chars, const std::u32string &replacement)
+		template <typename String>
+		String filter_consecutive_special_chars_impl(std::u32string_view input, std::u32string_view special_chars, std::u32string_view replacement, String output)
 		{
-			std::u32string output;
-			std::map<char32_t, bool> special_char_map;
-
 			// 初始化特殊字符表
-			for (const auto &ch : special_chars)
-			{
-				special_char_map[ch] = true;
-			}
+			using allocator_t = std::allocator_traits<typename String::allocator_type>;
+			using set_t = std::set<char32_t, std::less<char32_t>, typename allocator_t::template rebind_alloc<char32_t>>;
+			set_t special_char_set(special_chars.begin(), special_chars.end(), output.get_allocator());
 
 			bool has_special_char = false;
 
 			for (const auto &ch : input)
 			{
-				if (special_char_map.count(ch))
+				if (special_char_set.count(ch))
 				{
 					has_special_char = true;
 				}
@@ -399,11 +442,19 @@ namespace tools
 
 			return output;
 		}
+		std::u32string filter_consecutive_special_chars(const std::u32string &input, const std::u32string &special_chars, const std::u32string &replacement)
+		{
+			return filter_consecutive_special_chars_impl(input, special_chars, replacement, std::u32string());
+		}
+		std::pmr::u32string filter_consecutive_special_chars(std::u32string_view input, std::u32string_view special_chars, std::u32string_view replacement, std::pmr::memory_resource *resource)
+		{
+			return filter_consecutive_special_chars_impl(input, special_chars, replacement, std::pmr::u32string(resource));
+		}
 
 		// 按特殊字符串分割  input:目标字符串 delimiter:分隔字符
-		std::vector<std::u32string> split_by_special_string(const std::u32string &input, const std::u32string &delimiter)
+		template <typename Strings>
+		Strings split_by_special_string_impl(std::u32string_view input, std::u32string_view delimiter, Strings output)
 		{
-			std::vector<std::u32string> output;
 			size_t left = 0;
 
 			while (left < input.size())
@@ -412,7 +463,7 @@ namespace tools
 				size_t right = input.find(delimiter, left);
 
 				// 如果找到分隔符
-				if (right != std::u32string::npos)
+				if (right != std::u32string_view::npos)
 				{
 					if (right > left)
 					{ // 确保非空
@@ -433,6 +484,14 @@ namespace tools
 
 			return output;
 		}
+		std::vector<std::u32string> split_by_special_string(const std::u32string &input, const std::u32string &delimiter)
+		{
+			return split_by_special_string_impl(input, delimiter, std::vector<std::u32string>());
+		}
+		std::pmr::vector<std::pmr::u32string> split_by_special_string(std::u32string_view input, std::u32string_view delimiter, std::pmr::memory_resource *resource)
+		{
+			return split_by_special_string_impl(input, delimiter, std::pmr::vector<std::pmr::u32string>(resource));
+		}
 	}
 
 #ifdef tools_debug
@@ -487,6 +546,69 @@ namespace tools
 				std::cerr << "ERR:测试按特殊字符串分割" << std::endl;
 			}
 			std::cout << "测试按特殊字符串分割测试通过。" << std::endl;
+
+			// pmr 版本：全部分配都来自栈上缓冲区，上游为空资源，任何堆分配都会抛出异常
+			std::array<std::byte, 4096> storage;
+			std::pmr::monotonic_buffer_resource resource(storage.data(), storage.size(), std::pmr::null_memory_resource());
+			std::pmr::u32string pmr_utf32 = utf8_to_utf32(utf8_str, &resource);
+			std::pmr::vector<std::pmr::u32string> specials({ std::pmr::u32string(U"@", &resource), std::pmr::u32string(U"##", &resource) }, &resource);
+			std::pmr::u32string pmr_filtered = filter_consecutive_special_string(U"aa@@bb##", specials, U"_", &resource);
+			std::pmr::vector<std::pmr::u32string> pmr_parts = split_by_special_string(U"aa@@bb@@cc", delimiter, &resource);
+			// 验证转换正确性
+			if (!(std::string_view(utf32_to_utf8(pmr_utf32, &resource)) == utf8_str && pmr_filtered == U"aa__bb_" && pmr_parts.size() == 3 && pmr_parts[1] == U"bb"))
+			{
+				std::cerr << "ERR:测试 pmr 字符串函数" << std::endl;
+			}
+			std::cout << "pmr 字符串函数测试通过。" << std::endl;
+		}
+
+		// 测试数据容器相关功能
+		void test_data_container_functions()
+		{
+			using namespace tools::data_container;
+
+			std::cout << "正在测试数据容器相关功能..." << std::endl;
+
+			// 多线程通过 update 累加小结构体
+			struct stats
+			{
+				u32 count;
+				u32 sum;
+			};
+			atomic_data<stats> data(stats{ 0, 0 });
+			std::vector<std::thread> threads;
+			for (i32 i = 0; i < 4; ++i)
+			{
+				threads.emplace_back([&data]() {
+					for (i32 j = 0; j < 10000; ++j)
+					{
+						data.update([](stats& s) {
+							s.count += 1;
+							s.sum += 2;
+						});
+					}
+				});
+			}
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+			stats result = data.load();
+			// 验证更新结果
+			if (!(result.count == 40000 && result.sum == 80000))
+			{
+				std::cerr << "ERR:测试 atomic_data::update" << std::endl;
+			}
+			std::cout << "atomic_data::update 测试通过。" << std::endl;
+
+			// 比较并更新
+			atomic_data<u64> value(1);
+			u64 expected = 2;
+			if (value.compare_and_update(expected, 3) || expected != 1 || !value.compare_and_update(expected, 3) || value.load() != 3)
+			{
+				std::cerr << "ERR:测试 atomic_data::compare_and_update" << std::endl;
+			}
+			std::cout << "atomic_data::compare_and_update 测试通过。" << std::endl;
 		}
 
 		void all_test()
@@ -495,6 +617,7 @@ namespace tools
 			{
 				tools::test::test_terminal_functions(); // 测试终端相关功能
 				tools::test::test_string_functions();	// 测试字符串相关功能
+				tools::test::test_data_container_functions(); // 测试数据容器相关功能
 				//tools::test::test_file_functions();		// 测试文件操作相关功能
 			}
 			catch (const std::exception& ex)
@@ -16,6 +16,7 @@
 
 #include <cstring>
 #include <string>
+#include <string_view>
 
 #include <sstream>
 #include <fstream>
@@ -27,11 +28,13 @@
 #include <unordered_set>
 #include <map>
 #include <set>
+#include <memory_resource>
 
 #include <future>
 #include <thread>
 #include <atomic>
 #include <limits>
+#include <type_traits>
 
 #include<exception>
 
@@ -95,6 +98,12 @@ namespace tools
 		std::u32string utf8_to_utf32(const std::string &utf8_str);
 		std::string utf32_to_utf8(const std::u32string &utf32_str);
 
+		// 以上转换的 pmr 版本，结果从 resource 分配
+		std::pmr::u16string utf8_to_utf16(std::string_view utf8_str, std::pmr::memory_resource *resource);
+		std::pmr::string utf16_to_utf8(std::u16string_view utf16_str, std::pmr::memory_resource *resource);
+		std::pmr::u32string utf8_to_utf32(std::string_view utf8_str, std::pmr::memory_resource *resource);
+		std::pmr::string utf32_to_utf8(std::u32string_view utf32_str, std::pmr::memory_resource *resource);
+
 		// 工具函数：从UTF-8转换为本地编码（宽字符版本）
 		std::wstring utf8_to_wchar(const std::string &utf8_str);
 
@@ -103,12 +112,18 @@ namespace tools
 
 		// 连续特殊字符过滤器  input:目标字符串 special_string:过滤字符字符串 replacement:替换目标字符串
 		std::u32string filter_consecutive_special_string(const std::u32string &input, const std::vector<std::u32string> &special_strings, const std::u32string &replacement);
+		// pmr 版本，结果与内部临时容器均从 resource 分配
+		std::pmr::u32string filter_consecutive_special_string(std::u32string_view input, const std::pmr::vector<std::pmr::u32string> &special_strings, std::u32string_view replacement, std::pmr::memory_resource *resource);
 
 		// 连续特殊字符过滤器  input:目标字符串 special_chars:过滤字符 replacement:替换目标字符串
 		std::u32string filter_consecutive_special_chars(const std::u32string &input, const std::u32string &special_chars, const std::u32string &replacement);
+		// pmr 版本，结果与内部临时容器均从 resource 分配
+		std::pmr::u32string filter_consecutive_special_chars(std::u32string_view input, std::u32string_view special_chars, std::u32string_view replacement, std::pmr::memory_resource *resource);
 
 		// 按特殊字符串分割  input:目标字符串 delimiter:分隔字符
 		std::vector<std::u32string> split_by_special_string(const std::u32string &input, const std::u32string &delimiter);
+		// pmr 版本，向量及其中的每个字符串均从 resource 分配
+		std::pmr::vector<std::pmr::u32string> split_by_special_string(std::u32string_view input, std::u32string_view delimiter, std::pmr::memory_resource *resource);
 	}
 	namespace data_container
 	{
@@ -180,10 +195,30 @@ namespace tools
 			};
 		};
 
+		namespace local
+		{
+			// 判断 T 能否走 CAS 无锁路径：可平凡复制、不超过 16 字节且 atomic_ref<T> 恒为无锁
+			template <typename T, bool = std::is_trivially_copyable_v<T>>
+			struct lock_free_traits {
+				static constexpr bool value = false;
+				static constexpr size_t alignment = alignof(T);
+			};
+
+			template <typename T>
+			struct lock_free_traits<T, true> {
+				static constexpr bool value = sizeof(T) <= 16 && std::atomic_ref<T>::is_always_lock_free;
+				static constexpr size_t alignment = value ? std::atomic_ref<T>::required_alignment : alignof(T);
+			};
+		}
+
 		template <typename T>
 		class atomic_data {
+		public:
+			// 编译期确定 update / compare_and_update 是否为无锁实现
+			static constexpr bool is_lock_free_update = local::lock_free_traits<T>::value;
+
 		private:
-			T data;                // 存储的数据
+			alignas(local::lock_free_traits<T>::alignment) T data; // 存储的数据
 			atomic_apin_lock spin_lock;  // 自旋锁
 
 		public:
@@ -237,6 +272,64 @@ namespace tools
 					throw std::runtime_error("Access denied: lock is not held by the current thread");
 				}
 			}
+
+			// 读取数据快照（无需持有锁）
+			// 注意：无锁路径下 load / update / compare_and_update 不经过自旋锁，
+			// 不要与 lock() + get_data() 的修改并发混用
+			inline T load() {
+				if constexpr (is_lock_free_update) {
+					return std::atomic_ref<T>(data).load(std::memory_order_acquire);
+				}
+				else {
+					atomic_apin_lock::auto_lock guard(spin_lock);
+					return data;
+				}
+			}
+
+			// 原子更新数据  fn:接收 T& 并就地修改的函数，返回更新后的值
+			// 无锁路径下 fn 可能被多次调用，不应带有副作用
+			template <typename Fn>
+			inline T update(Fn&& fn) {
+				if constexpr (is_lock_free_update) {
+					std::atomic_ref<T> ref(data);
+					T expected = ref.load(std::memory_order_relaxed);
+					T desired = expected;
+					do {
+						desired = expected;
+						fn(desired);
+					} while (!ref.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_relaxed));
+					return desired;
+				}
+				else {
+					atomic_apin_lock::auto_lock guard(spin_lock);
+					fn(data);
+					return data;
+				}
+			}
+
+			// 比较并更新：当前值等于 expected 时写入 desired 并返回 true，
+			// 否则将当前值写回 expected 并返回 false
+			inline bool compare_and_update(T& expected, const T& desired) {
+				if constexpr (is_lock_free_update) {
+					return std::atomic_ref<T>(data).compare_exchange_strong(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+				}
+				else {
+					atomic_apin_lock::auto_lock guard(spin_lock);
+					bool equal;
+					if constexpr (std::is_trivially_copyable_v<T>) {
+						equal = std::memcmp(&data, &expected, sizeof(T)) == 0;
+					}
+					else {
+						equal = data == expected;
+					}
+					if (equal) {
+						data = desired;
+						return true;
+					}
+					expected = data;
+					return false;
+				}
+			}
 		};
 		template <typename T>
 		class atomic_ptr {
@@ -306,6 +399,9 @@ namespace tools
 		// 测试字符串相关功能
 		void test_string_functions();
 
+		// 测试数据容器相关功能
+		void test_data_container_functions();
+
 		// 测试文件操作相关功能
 		///void test_file_functions();
 